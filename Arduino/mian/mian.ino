@@ -44,7 +44,7 @@ DataSender sender;
 
 
 LCDView display(&lcd);         // Crea el módulo de visualización LCD.
-SDLogger sdlog(chipSelect);    // Crea el módulo para guardar datos en la tarjeta SD.
+SDLogger sdlog(chipSelect, false);    // Crea el módulo para guardar datos en la SD (true = formato binario compacto en datos.bin).
 InputManager input(botonPin);  // Crea el módulo que gestiona el botón y los comandos serie.
 
 
@@ -86,6 +86,8 @@ void loop() {
   input.checkSerialCommands(estadoVolt, estadoAmp, estadoPot, estadoTemp, estadoInd, estadoCap, opcion);
 
 
+  unsigned long tCaptura = micros();   // Momento de la captura: viaja con el mensaje para medir la latencia en el visor
+
   // Lecturas según estados
   volt.measure();       // Si el voltímetro está habilitado, mide el voltaje.
   amp.measure();         // Si el amperímetro está habilitado, mide la corriente.
@@ -115,6 +117,7 @@ void loop() {
 
   // --- Enviar estado actual al puerto serie en un solo mensaje ---
  sender.send(
+        tCaptura,
         estadoVolt, volt.getValue(),
         estadoAmp,  amp.getValue(),
         estadoPot,  pot.getValue(),
@@ -123,5 +126,8 @@ void loop() {
         estadoCap,  cap.getDisplayString()
     );
   
-  delay(200); // Pequeño retardo para evitar saturar lectura y puerto serie.
+  // Pequeño retardo para evitar saturar lectura y puerto serie.
+  // Mientras tanto se contestan los ping del visor, para que la ida y vuelta no incluya la espera.
+  unsigned long inicioEspera = millis();
+  while (millis() - inicioEspera < 200) input.atenderPing();
 }
\ No newline at end of file
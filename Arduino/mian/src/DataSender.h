@@ -6,12 +6,18 @@
 // -----------------------------------------------------------------------------
 //  Clase DataSender: se encarga de construir un string con los valores activos
 //  y enviarlo mediante Serial en un nico println() por ciclo.
+//  Cada mensaje empieza con un nmero de secuencia (S), el micros() del
+//  momento de la medicin (U) y el micros() del envo (E), para que el visor
+//  mida latencia y prdidas. E - U es el tiempo que la muestra pas en el Arduino.
 // -----------------------------------------------------------------------------
 class DataSender {
+private:
+	unsigned long secuencia;   // Nmero de secuencia del prximo mensaje enviado
+	
 public:
 	
-	// Constructor vaco (no hace nada especial)
-	DataSender() {}
+	// Constructor: la secuencia arranca en 0 (el visor detecta as un reinicio)
+	DataSender() : secuencia(0) {}
 	
 	// Inicializa el puerto serie a la velocidad dada
 	void begin(long baudRate){
@@ -20,9 +26,10 @@ public:
 		
 		// ---------------------------------------------------------------------
 		// Mtodo send(): recibe los estados y valores y arma un string final
-		// Ejemplo salida: "V12.03,T25.88,P40.21,"
+		// Ejemplo salida: "S152,U30412876,E30655120,V12.03,T25.88,P40.21,"
 		// ---------------------------------------------------------------------
 		void send(
+				  unsigned long tCaptura,       // micros() al momento de medir
 				  bool estVolt, float v,        // Estado y valor Voltaje
 				  bool estAmp,  float a,        // Estado y valor Corriente
 				  bool estPot,  float p,        // Estado y valor Potencia
@@ -75,9 +82,17 @@ public:
 				msg += ",";
 			}
 			
-			// Si hay algo para enviar, imprimir una sola lnea
+			// Si hay algo para enviar, imprimir una sola lnea con secuencia y tiempo al principio
 			if (msg.length() > 0) {
-				Serial.println(msg);
+				String marca = "S";
+				marca += String(secuencia);
+				marca += ",U";
+				marca += String(tCaptura);
+				marca += ",E";
+				marca += String(micros());   // Momento del envo: el visor ajusta su reloj con este valor
+				marca += ",";
+				Serial.println(marca + msg);
+				secuencia++;     // Solo cuenta los mensajes enviados: un salto en el visor es una lnea perdida
 			}
 		}
 };
@@ -9,6 +9,8 @@ class InputManager {   // Clase que maneja el bot
 		unsigned long lastDebounce;         // Tiempo del ltimo cambio detectado (millis)
 		bool lastState;                     // ltimo estado ledo del pin (HIGH/LOW)
 		const unsigned long debounceDelay = 300; // Tiempo de debounce en ms
+		
+		void responderPing(char id) { Serial.print('K'); Serial.println(id); }
 	
 	public:
 		// Constructor: guarda pin y configura INPUT_PULLUP
@@ -43,13 +45,24 @@ class InputManager {   // Clase que maneja el bot
 			lastState = lectura;
 		}
 		
+		// Responde en el acto los ping del visor: una letra minscula (su identificador) que vuelve
+		// como la lnea "K<letra>". Con la ida y vuelta el visor mide el retardo fijo del USB, que la
+		// latencia de un solo sentido no puede ver. Se llama durante la espera del loop; los comandos
+		// (maysculas) quedan en el buffer para checkSerialCommands().
+		void atenderPing() {
+			while (Serial.available() > 0 && Serial.peek() >= 'a' && Serial.peek() <= 'z') {
+				responderPing((char)Serial.read());
+			}
+		}
+		
 		// Lee el puerto serie y actualiza estados/opcion
 		void checkSerialCommands(bool &estadoVolt, bool &estadoAmp, bool &estadoPot, bool &estadoTemp, bool &estadoInd, bool &estadoCap, int &opcion)
 		{
 			String codigo = "";
 			while (Serial.available() > 0) {
 				char c = Serial.read();
-				if (c != '\n' && c != '\r') codigo += c;
+				if (c >= 'a' && c <= 'z') responderPing(c);   // Un ping que lleg durante las mediciones
+				else if (c != '\n' && c != '\r') codigo += c;
 			}
 			if (codigo.length() == 0) return;
 			if (codigo == "V1") { estadoVolt = true; opcion = 1; }
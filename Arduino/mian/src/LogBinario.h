@@ -0,0 +1,214 @@
+#ifndef LOGBINARIO_H
+#define LOGBINARIO_H
+
+#include <stdint.h>   // Tipos de ancho fijo. No depende de Arduino.h para poder compilarse también en la PC (decodificador).
+
+// -----------------------------------------------------------------------------
+//  Formato binario compacto para el registro en SD ("datos.bin").
+//
+//  Cabecera (una sola vez, cuando el archivo está vacío):
+//    'M' 'B' 'L' | version | nCanales | intervaloClave |
+//    por cada canal: largoNombre, nombre (sin '\0'), escala (varint)
+//
+//  Registro clave (cada 'intervaloClave' registros):
+//    0xA5 0x5A | millis (varint) | valor de cada canal (zigzag varint) | verificación del bloque | CRC-16
+//  Registro clave de inicio (al arrancar o después de una escritura fallida):
+//    0xA5 0x5B | millis (varint) | valor de cada canal (zigzag varint) | CRC-16
+//  El CRC-16 de la clave (CCITT, byte alto primero) cubre todo lo que sigue a 0xA5.
+//  Las claves son pocas y a partir de ellas se resincroniza, por eso llevan un CRC más largo.
+//
+//  Registro delta (todos los demás):
+//    variación del período (zigzag varint) | máscara de canales que cambiaron (1 byte) |
+//    valor - valorAnterior de cada canal que cambió (zigzag varint) | verificación
+//
+//  La variación del período es (millis - millisAnterior) - períodoAnterior: con un registro
+//  cada 5 s solo queda el jitter y ocupa 1 byte en lugar de 2. Después de cada clave el
+//  período anterior vale 0, así que el primer delta del bloque lleva el período completo.
+//
+//  La verificación de un delta es el CRC-8 (polinomio 0x07) del registro ya reconstruido
+//  (millis y valores absolutos), así que un delta solo pasa si suma bien sobre el anterior.
+//  La verificación del bloque es otro CRC-8 (polinomio 0x31) de todos los deltas del bloque
+//  que termina; la clave de inicio no la trae porque el bloque anterior pudo quedar cortado.
+//
+//  Los valores se guardan en punto fijo: entero = round(valor * escala).
+//  Los canales que no cambiaron no ocupan lugar; con señales que cambian lento cada valor
+//  que cambia ocupa 1 byte, contra ~40 bytes por línea en texto.
+//  Los registros clave permiten volver a sincronizar si una escritura quedó cortada.
+// -----------------------------------------------------------------------------
+
+#define LOGBIN_VERSION          2      // Versión del formato
+#define LOGBIN_SYNC_0           0xA5   // Primer byte de la marca de sincronismo
+#define LOGBIN_SYNC_1           0x5A   // Segundo byte: clave que cierra un bloque completo
+#define LOGBIN_SYNC_1_INICIO    0x5B   // Segundo byte: clave de inicio (el bloque anterior pudo quedar cortado)
+#define LOGBIN_POLI_REGISTRO    0x07   // Polinomio del CRC de cada registro
+#define LOGBIN_POLI_BLOQUE      0x31   // Polinomio del CRC de cada bloque
+#define LOGBIN_INTERVALO_CLAVE  32     // Cada cuántos registros se escribe uno clave
+#define LOGBIN_MAX_CANALES      8      // Cantidad máxima de canales por registro
+#define LOGBIN_MAX_NOMBRE       7      // Largo máximo del nombre de un canal
+
+// Tamaños máximos de buffer (un varint de 32 bits ocupa hasta 5 bytes)
+#define LOGBIN_MAX_CABECERA     (6 + LOGBIN_MAX_CANALES * (1 + LOGBIN_MAX_NOMBRE + 5))
+#define LOGBIN_MAX_REGISTRO     (2 + 5 + 1 + LOGBIN_MAX_CANALES * 5 + 3)
+
+
+// Zigzag: lleva enteros con signo a sin signo para que los valores chicos (positivos o negativos) ocupen pocos bytes.
+// 0 -> 0, -1 -> 1, 1 -> 2, -2 -> 3 ...
+inline uint32_t zigzag(int32_t v) {
+	return ((uint32_t)v << 1) ^ (uint32_t)(-(int32_t)((uint32_t)v >> 31));
+}
+
+inline int32_t unzigzag(uint32_t u) {
+	return (int32_t)((u >> 1) ^ (uint32_t)(-(int32_t)(u & 1)));
+}
+
+
+// Escribe 'v' como varint (7 bits por byte, el bit alto indica que sigue otro byte).
+// Devuelve la cantidad de bytes escritos (1 a 5).
+inline uint8_t escribirVarint(uint8_t* buf, uint32_t v) {
+	uint8_t n = 0;
+	while (v >= 0x80) {
+		buf[n++] = (uint8_t)(v | 0x80);
+		v >>= 7;
+	}
+	buf[n++] = (uint8_t)v;
+	return n;
+}
+
+
+// Agrega un byte a un CRC-8 con el polinomio indicado.
+inline uint8_t crc8Agregar(uint8_t crc, uint8_t dato, uint8_t poli) {
+	crc ^= dato;
+	for (uint8_t b = 0; b < 8; b++) {
+		crc = (crc & 0x80) ? (uint8_t)((crc << 1) ^ poli) : (uint8_t)(crc << 1);
+	}
+	return crc;
+}
+
+
+// CRC-16 CCITT (polinomio 0x1021, valor inicial 0xFFFF) para validar los registros clave.
+inline uint16_t crc16(const uint8_t* datos, uint8_t largo) {
+	uint16_t crc = 0xFFFF;
+	for (uint8_t i = 0; i < largo; i++) {
+		crc ^= (uint16_t)datos[i] << 8;
+		for (uint8_t b = 0; b < 8; b++) {
+			crc = (crc & 0x8000) ? (uint16_t)((crc << 1) ^ 0x1021) : (uint16_t)(crc << 1);
+		}
+	}
+	return crc;
+}
+
+
+// Agrega a 'crc' un registro reconstruido: millis y cada valor en punto fijo (4 bytes, el menos significativo primero).
+inline uint8_t crcEstado(uint8_t crc, uint32_t ms, const int32_t* valores, uint8_t n, uint8_t poli) {
+	for (uint8_t i = 0; i < 4; i++) crc = crc8Agregar(crc, (uint8_t)(ms >> (8 * i)), poli);
+	for (uint8_t c = 0; c < n; c++) {
+		for (uint8_t i = 0; i < 4; i++) crc = crc8Agregar(crc, (uint8_t)((uint32_t)valores[c] >> (8 * i)), poli);
+	}
+	return crc;
+}
+
+
+// Convierte un float a punto fijo con redondeo. Satura en el rango de int32 y lleva NaN a 0.
+inline int32_t aPuntoFijo(float x, uint16_t escala) {
+	float y = x * escala;
+	if (!(y == y)) return 0;                          // NaN
+	if (y >= 2147483647.0f) return 2147483647L;
+	if (y <= -2147483648.0f) return -2147483647L - 1;
+	return (int32_t)(y >= 0 ? y + 0.5f : y - 0.5f);
+}
+
+
+// Canales que guarda SDLogger, en el mismo orden que las columnas de datos.txt.
+// Están acá (y no en SDLogger.h) para que el decodificador de PC use exactamente los mismos.
+#define LOG_CANALES  5
+static const char* const canalesLog[LOG_CANALES] = { "t", "v", "a", "p", "ind" };
+static const uint16_t escalasLog[LOG_CANALES]    = { 100, 100, 100, 100, 100 };   // 2 decimales, igual que print()
+
+
+// -----------------------------------------------------------------------------
+//  Clase CodificadorLog: arma la cabecera y codifica cada registro en un buffer
+//  que después se escribe de una sola vez en el archivo.
+// -----------------------------------------------------------------------------
+class CodificadorLog {
+	private:
+		uint8_t nCanales;                       // Cantidad de canales por registro
+		const char* const* nombres;             // Nombre de cada canal (se guarda en la cabecera)
+		const uint16_t* escalas;                // Escala de punto fijo de cada canal
+		int32_t previo[LOGBIN_MAX_CANALES];     // Valores del registro anterior (para los deltas)
+		uint32_t millisPrevio;                  // Tiempo del registro anterior
+		uint32_t periodoPrevio;                 // millis entre los dos registros anteriores (0 después de una clave)
+		uint8_t desdeClave;                     // Registros escritos desde el último registro clave
+		uint8_t crcBloque;                      // Verificación de los deltas del bloque actual
+		bool pedirClave;                        // Fuerza que el próximo registro sea una clave de inicio
+	public:
+		CodificadorLog(uint8_t n, const char* const* nom, const uint16_t* esc)
+			: nCanales(n > LOGBIN_MAX_CANALES ? LOGBIN_MAX_CANALES : n), nombres(nom), escalas(esc),
+			  millisPrevio(0), periodoPrevio(0), desdeClave(0), crcBloque(0), pedirClave(true) {}
+
+		// Hace que el próximo registro sea una clave de inicio (por ejemplo si falló una escritura).
+		void forzarClave() { pedirClave = true; }
+
+		// Escribe la cabecera en 'buf' (mínimo LOGBIN_MAX_CABECERA bytes). Devuelve su largo.
+		uint8_t cabecera(uint8_t* buf) {
+			uint8_t n = 0;
+			buf[n++] = 'M'; buf[n++] = 'B'; buf[n++] = 'L';
+			buf[n++] = LOGBIN_VERSION;
+			buf[n++] = nCanales;
+			buf[n++] = LOGBIN_INTERVALO_CLAVE;
+			for (uint8_t c = 0; c < nCanales; c++) {
+				uint8_t largo = 0;
+				while (nombres[c][largo] != '\0' && largo < LOGBIN_MAX_NOMBRE) largo++;
+				buf[n++] = largo;
+				for (uint8_t i = 0; i < largo; i++) buf[n++] = (uint8_t)nombres[c][i];
+				n += escribirVarint(buf + n, escalas[c]);
+			}
+			return n;
+		}
+
+		// Codifica un registro en 'buf' (mínimo LOGBIN_MAX_REGISTRO bytes). Devuelve su largo.
+		uint8_t codificar(uint32_t ms, const float* valores, uint8_t* buf) {
+			uint8_t n = 0;
+			bool clave = pedirClave || desdeClave >= LOGBIN_INTERVALO_CLAVE;
+
+			int32_t q[LOGBIN_MAX_CANALES];
+			for (uint8_t c = 0; c < nCanales; c++) q[c] = aPuntoFijo(valores[c], escalas[c]);
+
+			if (clave) {
+				buf[n++] = LOGBIN_SYNC_0;
+				buf[n++] = pedirClave ? LOGBIN_SYNC_1_INICIO : LOGBIN_SYNC_1;
+				n += escribirVarint(buf + n, ms);
+				for (uint8_t c = 0; c < nCanales; c++) n += escribirVarint(buf + n, zigzag(q[c]));
+				if (!pedirClave) buf[n++] = crcBloque;   // Cierra el bloque anterior, que se escribió completo
+				uint16_t crc = crc16(buf + 1, n - 1);    // El CRC cubre todo lo que sigue a 0xA5
+				buf[n++] = (uint8_t)(crc >> 8);
+				buf[n++] = (uint8_t)crc;
+				desdeClave = 0;
+				crcBloque = 0;
+				periodoPrevio = 0;
+				pedirClave = false;
+			} else {
+				uint32_t periodo = ms - millisPrevio;
+				n += escribirVarint(buf + n, zigzag((int32_t)(periodo - periodoPrevio)));
+				periodoPrevio = periodo;
+				uint8_t mascara = 0;
+				for (uint8_t c = 0; c < nCanales; c++) {
+					if (q[c] != previo[c]) mascara |= (uint8_t)(1 << c);
+				}
+				buf[n++] = mascara;
+				for (uint8_t c = 0; c < nCanales; c++) {
+					if (!(mascara & (1 << c))) continue;
+					// La resta se hace sin signo para que el desborde sea definido (el decodificador suma igual)
+					n += escribirVarint(buf + n, zigzag((int32_t)((uint32_t)q[c] - (uint32_t)previo[c])));
+				}
+				buf[n++] = crcEstado(0, ms, q, nCanales, LOGBIN_POLI_REGISTRO);
+				crcBloque = crcEstado(crcBloque, ms, q, nCanales, LOGBIN_POLI_BLOQUE);
+			}
+
+			for (uint8_t c = 0; c < nCanales; c++) previo[c] = q[c];
+			millisPrevio = ms;
+			desdeClave++;
+			return n;
+		}
+};
+
+#endif
@@ -2,15 +2,28 @@
 #define SDLOGGER_H
 
 #include <SD.h>         // Incluye la librera para manejar tarjetas SD
+#include "LogBinario.h" // Codificador del formato binario compacto (canales y escalas del registro)
 
 class SDLogger {    // Clase encargada del guardado de datos en la SD
 	private:
 		int chipSelect;     // Pin CS (Chip Select) de la tarjeta SD
 		File myFile;        // Objeto para manipular archivos en la SD
+		bool binario;       // true = guarda en datos.bin (formato compacto), false = texto en datos.txt
+		CodificadorLog codificador;   // Mantiene el registro anterior para codificar los deltas
+		bool cabeceraRevisada;        // Ya se comprob que datos.bin empieza con una cabecera completa
+
+		// Compara el comienzo de myFile con la cabecera 'cab'. Deja el archivo posicionado al final.
+		bool cabeceraIgual(const uint8_t* cab, uint8_t largo) {
+			bool igual = myFile.size() >= largo && myFile.seek(0);
+			for (uint8_t i = 0; igual && i < largo; i++) igual = myFile.read() == cab[i];
+			myFile.seek(myFile.size());
+			return igual;
+		}
 	public:
-		SDLogger(int cs): chipSelect(cs) {}   // Constructor: guarda el pin CS
-		
-		
+		// Constructor: guarda el pin CS y el formato de guardado
+		SDLogger(int cs, bool bin = false): chipSelect(cs), binario(bin), codificador(LOG_CANALES, canalesLog, escalasLog), cabeceraRevisada(false) {}
+
+
 		void begin(){          // Inicializacin de la SD
 			if (!SD.begin(chipSelect)) {       // Intenta iniciar la tarjeta SD
 				Serial.println("Fallo SD");    // Si falla, muestra mensaje de error
@@ -19,9 +32,14 @@ class SDLogger {    // Clase encargada del guardado de datos en la SD
 			}       
 		}
 			
-        // Funcin que registra valores en el archivo datos.txt
+        // Funcin que registra valores en el archivo datos.txt (o datos.bin en modo binario)
 		void log(float v, float a, float p, float t, float ind) {
 			
+			if (binario) {      // En modo binario se usa el codificador
+				logBinario(v, a, p, t, ind);
+				return;
+			}
+
 			if (SD.begin(chipSelect)){       // Intenta inicializar SD antes de escribir
 				myFile = SD.open("datos.txt", FILE_WRITE);  // Abre/crea archivo para agregar datos
 				if (myFile) {      // Verifica si el archivo se abri correctamente
@@ -36,5 +54,55 @@ class SDLogger {    // Clase encargada del guardado de datos en la SD
 				}
 			}
 		}
+
+		// Registra un registro en datos.bin con el formato de LogBinario.h
+		// Se arma todo el registro en memoria y se escribe con un solo write().
+		void logBinario(float v, float a, float p, float t, float ind) {
+
+			if (SD.begin(chipSelect)){
+				myFile = SD.open("datos.bin", FILE_WRITE);
+				if (myFile) {
+					uint8_t buf[LOGBIN_MAX_CABECERA];
+					bool ok = true;
+					uint8_t largo = codificador.cabecera(buf);
+
+					// La primera vez se revisa que el archivo no haya quedado con la cabecera cortada
+					// (corte de luz mientras se escriba): si no coincide se empieza de nuevo.
+					if (!cabeceraRevisada && myFile.size() > 0 && !cabeceraIgual(buf, largo)) {
+						myFile.close();
+						SD.remove("datos.bin");
+						myFile = SD.open("datos.bin", FILE_WRITE);
+						if (!myFile) {
+							codificador.forzarClave();
+							return;
+						}
+					}
+					cabeceraRevisada = true;
+
+					// Archivo nuevo: primero se escribe la cabecera con los canales y escalas
+					if (myFile.size() == 0) {
+						ok = myFile.write(buf, largo) == largo;
+						codificador.forzarClave();
+						if (!ok) {      // Cabecera incompleta: se borra para que el prximo registro la escriba entera
+							myFile.close();
+							SD.remove("datos.bin");
+							return;
+						}
+					}
+
+					float valores[LOG_CANALES] = { t, v, a, p, ind };   // Mismo orden que canalesLog
+					largo = codificador.codificar(millis(), valores, buf);
+					ok = myFile.write(buf, largo) == largo;
+
+					myFile.close();
+
+					// Si algo no se escribi, el siguiente registro no puede ser un delta
+					if (!ok) codificador.forzarClave();
+					return;
+				}
+			}
+			codificador.forzarClave();   // No se pudo abrir la SD: el prximo registro arranca con clave
+			cabeceraRevisada = false;    // Puede ser otra tarjeta: se vuelve a revisar la cabecera
+		}
 };
-#endif
+#endif
\ No newline at end of file
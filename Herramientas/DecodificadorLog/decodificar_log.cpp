@@ -0,0 +1,616 @@
+// -----------------------------------------------------------------------------
+//  decodificar_log: herramienta de PC (Linux) para el formato binario de la SD.
+//
+//  Compilar:
+//    g++ -std=c++11 -O2 -o decodificar_log decodificar_log.cpp
+//
+//  Uso:
+//    decodificar_log datos.bin [salida.txt]      Convierte datos.bin al mismo CSV que datos.txt
+//    decodificar_log -c datos.txt datos.bin      Codifica un datos.txt existente al formato binario
+//    decodificar_log -e datos.bin                Muestra estadísticas (bytes por registro, compresión)
+//    decodificar_log -p [datos.txt ...]          Prueba de ida y vuelta y compresión (señales sintéticas
+//                                                y los archivos indicados, p. ej. muestras/datos_sd.txt)
+//
+//  datos.txt puede estar en el formato de la SD ("ms,t,v,a,p,ind") o en el que guarda el visor.
+//
+//  El formato está descripto en Arduino/mian/src/LogBinario.h, que se comparte con el firmware.
+// -----------------------------------------------------------------------------
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "../../Arduino/mian/src/LogBinario.h"   // Mismo codificador que usa el Arduino
+
+// Descripción de un canal leída de la cabecera
+struct Canal {
+	std::string nombre;
+	uint32_t escala;
+};
+
+// Un registro ya decodificado (tiempo y valores en punto fijo)
+struct Registro {
+	uint32_t ms;
+	int32_t valores[LOGBIN_MAX_CANALES];
+};
+
+// Un registro clave leído del archivo
+struct Clave {
+	Registro r;
+	bool inicio;             // Clave de inicio (no trae la verificación del bloque anterior)
+	uint8_t verifBloque;     // CRC de los deltas del bloque anterior
+	size_t fin;              // Posición siguiente a la clave
+};
+
+// Contadores que se informan con -e
+struct Estadisticas {
+	size_t registros = 0;    // Registros entregados
+	size_t claves = 0;       // Registros clave encontrados
+	size_t resincros = 0;    // Bloques rotos (hubo que buscar la siguiente marca)
+	size_t descartados = 0;  // Bytes salteados al buscar una marca de sincronismo
+	size_t perdidos = 0;     // Deltas ya decodificados que se descartaron por no poder confirmarse
+	size_t cortes = 0;       // Registros cortados por un reinicio o una escritura fallida
+	bool truncado = false;   // El archivo termina en medio de un registro
+};
+
+
+// Lee un varint desde 'pos'. Devuelve false si se acaba el buffer o tiene más de 5 bytes.
+static bool leerVarint(const std::vector<uint8_t>& buf, size_t& pos, uint32_t& valor) {
+	valor = 0;
+	for (int i = 0; i < 5; i++) {
+		if (pos >= buf.size()) return false;
+		uint8_t b = buf[pos++];
+		valor |= (uint32_t)(b & 0x7F) << (7 * i);
+		if (!(b & 0x80)) return true;
+	}
+	return false;
+}
+
+
+// Lee un archivo completo en memoria
+static bool leerArchivo(const char* ruta, std::vector<uint8_t>& datos) {
+	FILE* f = fopen(ruta, "rb");
+	if (!f) return false;
+	uint8_t tmp[4096];
+	size_t n;
+	while ((n = fread(tmp, 1, sizeof(tmp), f)) > 0) datos.insert(datos.end(), tmp, tmp + n);
+	fclose(f);
+	return true;
+}
+
+
+// -----------------------------------------------------------------------------
+//  Clase DecodificadorLog: recorre el archivo binario y entrega cada registro.
+//
+//  Cada delta trae el CRC-8 del registro reconstruido, así que un delta
+//  corrido o alterado no suma bien sobre el anterior y se rechaza (salvo
+//  1 vez en 256). Como el error se arrastraría a los valores absolutos, un
+//  delta que pasa queda confirmado por los registros que le siguen, o por
+//  la verificación del bloque que trae la clave que lo cierra.
+//
+//  Cuando algo falla se descartan los dos últimos deltas (los que no tienen
+//  dos registros buenos detrás) y se busca la clave siguiente. Si un delta
+//  queda cortado por una clave de inicio (el Arduino se reinició o falló la
+//  escritura) los deltas anteriores están completos y se conservan. El
+//  último registro del archivo solo tiene su propio CRC-8.
+// -----------------------------------------------------------------------------
+class DecodificadorLog {
+	private:
+		const std::vector<uint8_t>& buf;
+		size_t pos;
+		uint8_t intervalo;              // Registros entre claves (de la cabecera)
+		std::vector<Registro> bloque;   // Registros del bloque ya validado
+		size_t enBloque;                // Próximo registro del bloque a entregar
+	public:
+		std::vector<Canal> canales;
+		Estadisticas est;
+
+		DecodificadorLog(const std::vector<uint8_t>& b)
+			: buf(b), pos(0), intervalo(LOGBIN_INTERVALO_CLAVE), enBloque(0) {}
+
+		// Lee la cabecera. Devuelve false si el archivo no es del formato esperado.
+		bool leerCabecera() {
+			if (buf.size() < 6 || buf[0] != 'M' || buf[1] != 'B' || buf[2] != 'L') return false;
+			if (buf[3] != LOGBIN_VERSION) return false;
+			uint8_t n = buf[4];
+			intervalo = buf[5];
+			if (n == 0 || n > LOGBIN_MAX_CANALES || intervalo == 0) return false;
+			pos = 6;
+			for (uint8_t c = 0; c < n; c++) {
+				if (pos >= buf.size()) return false;
+				uint8_t largo = buf[pos++];
+				if (largo > LOGBIN_MAX_NOMBRE || pos + largo > buf.size()) return false;
+				Canal canal;
+				canal.nombre.assign((const char*)&buf[pos], largo);
+				pos += largo;
+				if (!leerVarint(buf, pos, canal.escala) || canal.escala == 0) return false;
+				canales.push_back(canal);
+			}
+			return true;
+		}
+
+		// Intenta leer un registro clave en 'p'. Solo lo acepta si la marca y el CRC coinciden.
+		bool leerClave(size_t p, Clave& k) const {
+			if (p + 2 > buf.size() || buf[p] != LOGBIN_SYNC_0) return false;
+			if (buf[p + 1] != LOGBIN_SYNC_1 && buf[p + 1] != LOGBIN_SYNC_1_INICIO) return false;
+			k.inicio = buf[p + 1] == LOGBIN_SYNC_1_INICIO;
+			size_t q = p + 2;
+			if (!leerVarint(buf, q, k.r.ms)) return false;
+			for (size_t c = 0; c < canales.size(); c++) {
+				uint32_t u;
+				if (!leerVarint(buf, q, u)) return false;
+				k.r.valores[c] = unzigzag(u);
+			}
+			if (!k.inicio) {
+				if (q >= buf.size()) return false;
+				k.verifBloque = buf[q++];
+			}
+			if (q + 2 > buf.size() || q - (p + 1) > 255) return false;
+			uint16_t crc = crc16(&buf[p + 1], (uint8_t)(q - (p + 1)));
+			if (buf[q] != (uint8_t)(crc >> 8) || buf[q + 1] != (uint8_t)crc) return false;
+			k.fin = q + 2;
+			return true;
+		}
+
+		// Busca una clave válida que empiece en [desde, hasta). Devuelve su posición o 'hasta'.
+		size_t buscarClave(size_t desde, size_t hasta, Clave& k) const {
+			for (size_t p = desde; p < hasta; p++) {
+				if (leerClave(p, k)) return p;
+			}
+			return hasta;
+		}
+
+		// Bloque roto: se descartan los deltas que no llegaron a confirmarse.
+		// 'pos' queda donde se sigue buscando la próxima clave.
+		bool cerrarRoto() {
+			est.resincros++;
+			for (int i = 0; i < 2 && bloque.size() > 1; i++) {
+				bloque.pop_back();
+				est.perdidos++;
+			}
+			return true;
+		}
+
+		// Decodifica el siguiente bloque en 'bloque'. Devuelve false si no quedan claves.
+		bool leerBloque() {
+			bloque.clear();
+			enBloque = 0;
+
+			// Buscar la clave que abre el bloque
+			Clave k;
+			while (pos < buf.size() && !leerClave(pos, k)) {
+				pos++;
+				est.descartados++;
+			}
+			if (pos >= buf.size()) return false;
+			pos = k.fin;
+			bloque.push_back(k.r);
+			est.claves++;
+
+			const uint8_t n = (uint8_t)canales.size();
+			Registro previo = k.r;
+			uint32_t periodo = 0;        // millis entre los dos últimos registros (0 después de la clave)
+			uint8_t crcBloque = 0;
+			while (pos < buf.size()) {
+				// Empieza la clave siguiente (una de inicio puede venir antes por un reinicio).
+				// Si cierra un bloque completo, su verificación confirma el último delta.
+				if (leerClave(pos, k)) {
+					if (!k.inicio && k.verifBloque != crcBloque) return cerrarRoto();
+					return true;
+				}
+
+				// Ya debería haber llegado una clave: el bloque está roto
+				if (bloque.size() >= intervalo) return cerrarRoto();
+
+				// Registro delta
+				Registro r;
+				size_t q = pos;
+				uint32_t u;
+				bool completo = leerVarint(buf, q, u);
+				uint32_t periodoDelta = periodo + (uint32_t)unzigzag(u);
+				r.ms = previo.ms + periodoDelta;
+				uint8_t mascara = 0;
+				if (completo && q < buf.size()) mascara = buf[q++];
+				else completo = false;
+				for (size_t c = 0; c < n; c++) {
+					r.valores[c] = previo.valores[c];
+					if (!completo || !(mascara & (1 << c))) continue;
+					completo = leerVarint(buf, q, u);
+					r.valores[c] = (int32_t)((uint32_t)previo.valores[c] + (uint32_t)unzigzag(u));
+				}
+				if (completo && q >= buf.size()) completo = false;   // Falta el byte de verificación
+
+				// Si el delta se come el comienzo de una clave válida, una escritura quedó cortada
+				size_t hasta = completo ? q + 1 : buf.size();
+				size_t clave = buscarClave(pos + 1, hasta, k);
+				if (clave < hasta) {
+					pos = clave;
+					if (k.inicio) {        // Reinicio o escritura fallida: los deltas anteriores están completos
+						est.cortes++;
+						return true;
+					}
+					return cerrarRoto();   // En medio de un bloque normal: el archivo está dañado
+				}
+
+				// El archivo termina en medio de un registro. Si fuera un corte de luz el Arduino
+				// habría seguido con una clave de inicio, así que el último delta completo no se
+				// da por confirmado.
+				if (!completo) {
+					est.truncado = true;
+					pos = buf.size();
+					if (bloque.size() > 1) {
+						bloque.pop_back();
+						est.perdidos++;
+					}
+					return true;
+				}
+
+				// Una máscara con canales que no existen o un CRC que no coincide: registro dañado
+				if ((mascara >> n) != 0 || buf[q] != crcEstado(0, r.ms, r.valores, n, LOGBIN_POLI_REGISTRO)) return cerrarRoto();
+
+				pos = q + 1;
+				previo = r;
+				periodo = periodoDelta;
+				crcBloque = crcEstado(crcBloque, r.ms, r.valores, n, LOGBIN_POLI_BLOQUE);
+				bloque.push_back(r);
+			}
+			return true;   // Terminó justo al final del archivo
+		}
+
+		// Entrega el siguiente registro. Devuelve false al llegar al final del archivo.
+		bool siguiente(Registro& r) {
+			while (enBloque >= bloque.size()) {
+				if (!leerBloque()) return false;
+			}
+			r = bloque[enBloque++];
+			est.registros++;
+			return true;
+		}
+};
+
+
+// Escribe un registro con el mismo formato que SDLogger en datos.txt: "ms,t,v,a,p,ind" con 2 decimales.
+// Devuelve la cantidad de caracteres que ocuparía en la SD (incluye el "\r\n" de println()).
+static size_t escribirCSV(FILE* f, const std::vector<Canal>& canales, const Registro& r) {
+	char linea[256];
+	int n = snprintf(linea, sizeof(linea), "%lu", (unsigned long)r.ms);
+	for (size_t c = 0; c < canales.size(); c++) {
+		n += snprintf(linea + n, sizeof(linea) - n, ",%.2f", (double)r.valores[c] / canales[c].escala);
+	}
+	if (f) fprintf(f, "%s\n", linea);
+	return (size_t)n + 2;
+}
+
+
+// Modo por defecto: binario -> CSV
+static int decodificar(const char* entrada, const char* salida, bool soloEstadisticas) {
+	std::vector<uint8_t> datos;
+	if (!leerArchivo(entrada, datos)) {
+		fprintf(stderr, "No se pudo abrir %s\n", entrada);
+		return 1;
+	}
+
+	DecodificadorLog dec(datos);
+	if (!dec.leerCabecera()) {
+		fprintf(stderr, "%s no tiene una cabecera de log binario valida\n", entrada);
+		return 1;
+	}
+
+	FILE* f = NULL;
+	if (!soloEstadisticas) {
+		f = salida ? fopen(salida, "w") : stdout;
+		if (!f) {
+			fprintf(stderr, "No se pudo crear %s\n", salida);
+			return 1;
+		}
+	}
+
+	size_t bytesCSV = 0;
+	Registro r;
+	while (dec.siguiente(r)) bytesCSV += escribirCSV(f, dec.canales, r);
+	if (f && f != stdout) fclose(f);
+
+	const Estadisticas& e = dec.est;
+	if (e.resincros || e.descartados || e.cortes || e.truncado) {
+		fprintf(stderr, "Aviso: %zu bloques rotos (%zu registros descartados), %zu bytes salteados, %zu escrituras cortadas%s\n",
+		        e.resincros, e.perdidos, e.descartados, e.cortes, e.truncado ? ", ultimo registro truncado" : "");
+	}
+
+	if (soloEstadisticas) {
+		printf("Canales:            ");
+		for (size_t c = 0; c < dec.canales.size(); c++) printf("%s(x%u) ", dec.canales[c].nombre.c_str(), dec.canales[c].escala);
+		printf("\n");
+		printf("Registros:          %zu (%zu clave)\n", e.registros, e.claves);
+		printf("Bytes binario:      %zu\n", datos.size());
+		printf("Bytes CSV equiv.:   %zu\n", bytesCSV);
+		if (e.registros > 0) {
+			printf("Bytes por registro: %.2f binario, %.2f CSV\n",
+			       (double)datos.size() / e.registros, (double)bytesCSV / e.registros);
+			printf("Compresion:         %.2fx\n", (double)bytesCSV / datos.size());
+		}
+	}
+	return 0;
+}
+
+
+// Una fila de datos.txt: tiempo y canales en el orden de canalesLog (t, v, a, p, ind)
+struct Fila {
+	uint32_t ms;
+	float valores[LOG_CANALES];
+};
+
+
+// Lee un CSV en el formato de la SD ("ms,t,v,a,p,ind") o en el que guarda el visor de Processing
+// ("dd/mm/aaaa,hh:mm:ss[.mmm],v,a,p,t,ind,..."). En el segundo caso el tiempo se toma
+// relativo a la primera línea y las columnas se reordenan como en la SD.
+static bool leerCSV(const char* ruta, std::vector<Fila>& filas, size_t& ignoradas) {
+	FILE* in = fopen(ruta, "r");
+	if (!in) return false;
+
+	char linea[256];
+	double inicioVisor = -1;
+	ignoradas = 0;
+	while (fgets(linea, sizeof(linea), in)) {
+		Fila f;
+		unsigned long ms;
+		int dia, mes, anio, h, m;
+		float seg, v, a, p, t, ind;
+		if (strchr(linea, '/') == NULL &&
+		    sscanf(linea, "%lu,%f,%f,%f,%f,%f", &ms, &f.valores[0], &f.valores[1], &f.valores[2], &f.valores[3], &f.valores[4]) == 6) {
+			f.ms = (uint32_t)ms;
+		} else if (sscanf(linea, "%d/%d/%d,%d:%d:%f,%f,%f,%f,%f,%f", &dia, &mes, &anio, &h, &m, &seg, &v, &a, &p, &t, &ind) == 11) {
+			double s = h * 3600.0 + m * 60.0 + seg;
+			if (inicioVisor < 0) inicioVisor = s;
+			f.ms = (uint32_t)((s - inicioVisor) * 1000.0 + 0.5);
+			f.valores[0] = t; f.valores[1] = v; f.valores[2] = a; f.valores[3] = p; f.valores[4] = ind;
+		} else {
+			ignoradas++;
+			continue;
+		}
+		filas.push_back(f);
+	}
+	fclose(in);
+	return true;
+}
+
+
+// Codifica filas en memoria con el mismo codificador del firmware.
+// Si se pasa 'inicios', guarda ahí la posición donde empieza cada registro.
+static std::vector<uint8_t> codificarFilas(const std::vector<Fila>& filas, std::vector<size_t>* inicios = NULL) {
+	std::vector<uint8_t> salida;
+	CodificadorLog cod(LOG_CANALES, canalesLog, escalasLog);
+	uint8_t buf[LOGBIN_MAX_CABECERA];
+	uint8_t n = cod.cabecera(buf);
+	salida.insert(salida.end(), buf, buf + n);
+	for (size_t i = 0; i < filas.size(); i++) {
+		if (inicios) inicios->push_back(salida.size());
+		n = cod.codificar(filas[i].ms, filas[i].valores, buf);
+		salida.insert(salida.end(), buf, buf + n);
+	}
+	return salida;
+}
+
+
+// Modo -c: CSV (datos.txt) -> binario, usando el mismo codificador del firmware
+static int codificar(const char* entrada, const char* salida) {
+	std::vector<Fila> filas;
+	size_t ignoradas;
+	if (!leerCSV(entrada, filas, ignoradas)) {
+		fprintf(stderr, "No se pudo abrir %s\n", entrada);
+		return 1;
+	}
+	FILE* out = fopen(salida, "wb");
+	if (!out) {
+		fprintf(stderr, "No se pudo crear %s\n", salida);
+		return 1;
+	}
+
+	std::vector<uint8_t> datos = codificarFilas(filas);
+	fwrite(datos.data(), 1, datos.size(), out);
+	fclose(out);
+
+	fprintf(stderr, "%zu registros codificados", filas.size());
+	if (ignoradas) fprintf(stderr, ", %zu lineas ignoradas", ignoradas);
+	fprintf(stderr, "\n");
+	return 0;
+}
+
+
+// -----------------------------------------------------------------------------
+//  Modo -p: prueba de ida y vuelta y medición de compresión.
+//  Para cada conjunto de datos (señales sintéticas y los archivos pasados):
+//   1. codifica, decodifica y compara cada registro con la entrada en punto fijo
+//   2. informa bytes por registro contra el CSV de la SD
+//   3. borra de 1 a 5 bytes en cada posición de un intervalo de claves completo
+//      (desde una clave hasta la siguiente inclusive) y verifica que no salga
+//      ningún registro inventado
+//   4. corta un registro a la mitad y sigue con un arranque nuevo (reinicio en
+//      medio de una escritura): se tienen que recuperar todos los demás
+// -----------------------------------------------------------------------------
+
+// Señales sintéticas: 'tipo' 0 = lenta (temperatura con ruido chico, tensión casi fija),
+// 1 = escalones (se conecta/desconecta una carga), 2 = ruido grande en todos los canales
+static std::vector<Fila> generarSintetica(int tipo, size_t n) {
+	std::vector<Fila> filas;
+	uint32_t semilla = 12345;
+	uint32_t ms = 0;
+	float temp = 25.0f;
+	for (size_t i = 0; i < n; i++) {
+		semilla = semilla * 1103515245u + 12345u;
+		float ruido = ((semilla >> 16) % 1000) / 1000.0f - 0.5f;   // -0.5 .. 0.5
+		ms += 5000 + (semilla >> 8) % 4;                          // Período de la SD (5 s) con algo de jitter
+		Fila f;
+		f.ms = ms;
+		if (tipo == 0) {
+			temp += ruido * 0.06f;
+			f.valores[0] = temp;
+			f.valores[1] = 12.0f + 0.05f * (float)((i / 50) % 2);
+			f.valores[2] = 0.5f;
+			f.valores[3] = f.valores[1] * f.valores[2];
+			f.valores[4] = 70.2f;
+		} else if (tipo == 1) {
+			bool carga = (i / 40) % 2;
+			f.valores[0] = 25.0f + 0.01f * (float)(i / 100);
+			f.valores[1] = carga ? 11.8f : 12.1f;
+			f.valores[2] = carga ? 1.25f : 0.0f;
+			f.valores[3] = f.valores[1] * f.valores[2];
+			f.valores[4] = 0.0f;
+		} else {
+			f.valores[0] = 25.0f + ruido * 10.0f;
+			f.valores[1] = 12.0f + ruido * 5.0f;
+			f.valores[2] = 1.0f - ruido;
+			f.valores[3] = f.valores[1] * f.valores[2];
+			f.valores[4] = 100.0f + ruido * 50.0f;
+		}
+		filas.push_back(f);
+	}
+	return filas;
+}
+
+
+// Bytes que ocupa una fila en datos.txt (print() con 2 decimales y println())
+static size_t bytesFilaCSV(const Fila& f) {
+	char linea[256];
+	int n = snprintf(linea, sizeof(linea), "%lu", (unsigned long)f.ms);
+	for (int c = 0; c < LOG_CANALES; c++) n += snprintf(linea + n, sizeof(linea) - n, ",%.2f", (double)f.valores[c]);
+	return (size_t)n + 2;
+}
+
+
+// Compara un registro decodificado con una fila en punto fijo
+static bool iguales(const Registro& r, const Fila& f) {
+	if (r.ms != f.ms) return false;
+	for (int c = 0; c < LOG_CANALES; c++) {
+		if (r.valores[c] != aPuntoFijo(f.valores[c], escalasLog[c])) return false;
+	}
+	return true;
+}
+
+
+// Decodifica 'datos' y cuenta los registros que existen en 'filas' y los inventados
+static void contarRecuperados(const std::vector<uint8_t>& datos, const std::vector<Fila>& filas,
+                              size_t& recuperados, size_t& inventados) {
+	recuperados = inventados = 0;
+	DecodificadorLog dec(datos);
+	if (!dec.leerCabecera()) return;
+	Registro r;
+	size_t j = 0;
+	while (dec.siguiente(r)) {
+		while (j < filas.size() && filas[j].ms < r.ms) j++;   // La salida sigue ordenada en el tiempo
+		bool existe = false;                                   // Puede haber varias filas con el mismo ms
+		for (size_t k = j; k < filas.size() && filas[k].ms == r.ms && !existe; k++) existe = iguales(r, filas[k]);
+		if (existe) recuperados++;
+		else inventados++;
+	}
+}
+
+
+// Corre la prueba sobre un conjunto de filas. Devuelve false si falla.
+static bool probar(const char* nombre, const std::vector<Fila>& filas) {
+	std::vector<size_t> inicios;
+	std::vector<uint8_t> datos = codificarFilas(filas, &inicios);
+
+	// 1. Ida y vuelta
+	DecodificadorLog dec(datos);
+	bool ok = dec.leerCabecera();
+	Registro r;
+	size_t i = 0;
+	while (ok && dec.siguiente(r)) {
+		if (i >= filas.size() || !iguales(r, filas[i])) ok = false;
+		i++;
+	}
+	if (i != filas.size()) ok = false;
+
+	// 2. Tamaño
+	size_t bytesCSV = 0;
+	for (size_t k = 0; k < filas.size(); k++) bytesCSV += bytesFilaCSV(filas[k]);
+
+	// 3. Escrituras dañadas: todas las posiciones y largos de un intervalo de claves a mitad del archivo
+	size_t primera = (filas.size() / 2) / LOGBIN_INTERVALO_CLAVE * LOGBIN_INTERVALO_CLAVE;
+	size_t ultima = primera + LOGBIN_INTERVALO_CLAVE + 1;          // Incluye la clave que cierra el intervalo
+	size_t desde = inicios.empty() ? datos.size() : inicios[primera];
+	size_t hasta = ultima < inicios.size() ? inicios[ultima] : datos.size();
+	size_t casos = 0, inventados = 0, peorRecuperados = filas.size();
+	for (size_t p = desde; p < hasta; p++) {
+		for (size_t largo = 1; largo <= 5 && p + largo <= datos.size(); largo++) {
+			std::vector<uint8_t> roto = datos;
+			roto.erase(roto.begin() + p, roto.begin() + p + largo);
+			size_t rec, inv;
+			contarRecuperados(roto, filas, rec, inv);
+			casos++;
+			inventados += inv;
+			if (rec < peorRecuperados) peorRecuperados = rec;
+		}
+	}
+	if (inventados > 0) ok = false;
+
+	// 4. Reinicio en medio de una escritura: el registro 'corte' queda a medias y sigue un arranque nuevo
+	size_t corte = filas.size() * 3 / 5;
+	size_t peorReinicio = filas.size();
+	if (corte + 1 < inicios.size()) {
+		size_t largoCorte = inicios[corte + 1] - inicios[corte];
+		std::vector<Fila> esperadas(filas.begin(), filas.begin() + corte);
+		esperadas.insert(esperadas.end(), filas.begin() + corte + 1, filas.end());
+		std::vector<Fila> despues(filas.begin() + corte + 1, filas.end());
+		std::vector<size_t> iniciosArranque;
+		std::vector<uint8_t> arranque = codificarFilas(despues, &iniciosArranque);
+		size_t cabecera = iniciosArranque.empty() ? arranque.size() : iniciosArranque[0];   // El arranque nuevo no repite la cabecera
+		for (size_t l = 1; l < largoCorte; l++) {
+			std::vector<uint8_t> reinicio(datos.begin(), datos.begin() + inicios[corte] + l);
+			reinicio.insert(reinicio.end(), arranque.begin() + cabecera, arranque.end());
+			size_t rec, inv;
+			contarRecuperados(reinicio, esperadas, rec, inv);
+			if (inv > 0 || rec != esperadas.size()) ok = false;
+			if (rec < peorReinicio) peorReinicio = rec;
+		}
+	}
+
+	double n = filas.empty() ? 1 : (double)filas.size();
+	printf("%-24s %5zu reg  %5.2f B/reg bin  %5.2f B/reg CSV  %5.2fx  corte: %zu casos, %zu inventados, min %zu recuperados"
+	       "  reinicio: min %zu/%zu  %s\n",
+	       nombre, filas.size(), datos.size() / n, bytesCSV / n, datos.empty() ? 0.0 : (double)bytesCSV / datos.size(),
+	       casos, inventados, peorRecuperados, peorReinicio, filas.empty() ? 0 : filas.size() - 1, ok ? "OK" : "FALLA");
+	return ok;
+}
+
+
+static int pruebas(int argc, char** argv) {
+	bool ok = true;
+	ok &= probar("sintetica lenta", generarSintetica(0, 2000));
+	ok &= probar("sintetica escalones", generarSintetica(1, 2000));
+	ok &= probar("sintetica ruidosa", generarSintetica(2, 2000));
+
+	for (int i = 0; i < argc; i++) {
+		std::vector<Fila> filas;
+		size_t ignoradas;
+		if (!leerCSV(argv[i], filas, ignoradas) || filas.empty()) {
+			fprintf(stderr, "No se pudieron leer datos de %s\n", argv[i]);
+			ok = false;
+			continue;
+		}
+		ok &= probar(argv[i], filas);
+	}
+	return ok ? 0 : 1;
+}
+
+
+static void uso() {
+	fprintf(stderr,
+	        "Uso:\n"
+	        "  decodificar_log datos.bin [salida.txt]   binario -> CSV\n"
+	        "  decodificar_log -c datos.txt datos.bin   CSV -> binario\n"
+	        "  decodificar_log -e datos.bin             estadisticas de compresion\n"
+	        "  decodificar_log -p [datos.txt ...]       prueba ida y vuelta y compresion\n");
+}
+
+
+int main(int argc, char** argv) {
+	if (argc >= 2 && strcmp(argv[1], "-p") == 0) return pruebas(argc - 2, argv + 2);
+	if (argc >= 4 && strcmp(argv[1], "-c") == 0) return codificar(argv[2], argv[3]);
+	if (argc == 3 && strcmp(argv[1], "-e") == 0) return decodificar(argv[2], NULL, true);
+	if (argc == 2 || (argc == 3 && argv[1][0] != '-')) return decodificar(argv[1], argc == 3 ? argv[2] : NULL, false);
+	uso();
+	return 1;
+}
@@ -0,0 +1,393 @@
+// --------------------------------------------------------------------
+// ESTADÍSTICAS DEL ENLACE ARDUINO → PC
+// Cada línea de telemetría empieza con "S<secuencia>,U<micros>,E<micros>,":
+// U es el momento de la medición y E el del envío. Con E se estima el
+// offset y la deriva entre el reloj del Arduino y el de la PC; E - U es el
+// tiempo que la muestra pasó en el Arduino (mediciones, LCD) y se suma a la
+// latencia. También se cuentan las líneas perdidas y el uso del enlace.
+//
+// El offset sale del camino más rápido observado, así que las latencias
+// son relativas a él: el retardo mínimo del USB (timer de latencia del
+// FTDI/CH340, tramas de 1 ms) queda dentro del offset y no se ve. Para
+// acotarlo se mide un ping de ida y vuelta por el mismo puerto: el visor
+// manda una letra minúscula y el Arduino la devuelve como "K<letra>".
+//
+// Todos los tiempos internos están en microsegundos (long). Ojo: en
+// Processing los literales decimales son float, por eso los double llevan 'd'.
+// --------------------------------------------------------------------
+class EnlaceSerie {
+
+  int baudios;    // Velocidad del puerto (para el tiempo de transmisión y el uso del enlace)
+
+  // --- Secuencia ---
+  long ultimaSecuencia = -1;   // -1 = todavía no llegó ninguna línea con secuencia
+  long recibidas = 0;          // Líneas con secuencia recibidas
+  long perdidas = 0;           // Líneas que faltan según la secuencia
+  long huecos = 0;             // Cantidad de saltos en la secuencia
+  long duplicadas = 0;         // Secuencias repetidas o fuera de orden
+  long reinicios = 0;          // Veces que el Arduino se reinició (la secuencia volvió atrás)
+  long erroresParseo = 0;      // Líneas que no se pudieron interpretar
+
+  // Micros de envío de las últimas secuencias: una línea que vuelve atrás solo
+  // es duplicada si cae en esta ventana y trae el mismo micros que la original.
+  final int VENTANA_DUPLICADOS = 8;
+  long[] microsRecientes = new long[VENTANA_DUPLICADOS];
+
+  // --- Reloj del Arduino ---
+  long ultimoMicros = -1;      // Último micros() de envío crudo recibido
+  long vueltasMicros = 0;      // Desbordes de micros() (cada 2^32 us, ~71 minutos)
+
+  // --- Offset y deriva ---
+  // Se guarda el mínimo de (tPC - tArduino - tTransmisión) en bloques de 5 s.
+  // Una recta por debajo de esos mínimos (envolvente inferior) da el offset
+  // (ordenada) y la deriva entre relojes (pendiente).
+  final long DURACION_BLOQUE_US = 5000000L;
+  final int MAX_BLOQUES = 60;                               // 5 minutos de historia
+  ArrayList<long[]> bloques = new ArrayList<long[]>();      // {tArduino, mínimo} de cada bloque cerrado
+  long bloqueInicio = -1;                                   // tArduino de inicio del bloque actual
+  long[] bloqueActual = { 0, Long.MAX_VALUE };              // {tArduino, mínimo} del bloque actual
+  long tRef = 0;                                            // tArduino de referencia de la recta
+  double offsetUs = 0;                                      // Ordenada de la recta en tRef
+  double pendiente = 0;                                     // Deriva (us de PC por us de Arduino - 1)
+
+  // --- Latencia ---
+  float[] latencias = new float[500];                       // Últimas latencias muestra → pantalla (ms)
+  int numLatencias = 0, posLatencia = 0;
+  ArrayList<Long> pendientes = new ArrayList<Long>();       // Captura (reloj PC) de muestras aún no dibujadas
+  float latenciaLlegada = 0;                                // Captura → llegada de la última línea (ms)
+  long ultimaCapturaPc = -1;                                // Captura (reloj PC) de la última línea, -1 si fue duplicada
+  float tiempoEnArduino = 0;                                // Captura → envío de la última línea (ms)
+
+  // --- Ping (ida y vuelta por el mismo puerto) ---
+  final long PERIODO_PING_US = 2000000L;
+  final long ESPERA_PING_US = 5000000L;    // Sin respuesta en este tiempo se manda otro
+  char idPing = 'a';                       // Letra del ping en vuelo
+  long envioPing = -1;                     // Reloj PC del ping en vuelo, -1 = ninguno
+  long ultimoPing = -1;                    // Reloj PC del último ping enviado
+  long pings = 0;                          // Pings respondidos
+  long rttMinimo = Long.MAX_VALUE;         // Menor ida y vuelta sin los tiempos de transmisión (us)
+
+  // --- Uso del enlace ---
+  long bytesVentana = 0;       // Bytes recibidos en la ventana actual
+  long inicioVentana = -1;     // Inicio de la ventana actual (reloj PC)
+  float uso = 0;               // Fracción de la capacidad del enlace usada en la última ventana
+
+  // --- Grabación en curso (para el resumen que se exporta en _enlace.txt) ---
+  boolean grabando = false;
+  long inicioGrabacion = 0;                                 // Reloj PC al empezar a grabar
+  long bytesGrabacion = 0;                                  // Bytes recibidos desde que empezó la grabación
+  FloatList latenciasGrabacion = new FloatList();           // Muestra → pantalla de toda la grabación (ms)
+  FloatList llegadasGrabacion = new FloatList();            // Captura → llegada de toda la grabación (ms)
+  FloatList enArduinoGrabacion = new FloatList();           // Captura → envío de toda la grabación (ms)
+
+  EnlaceSerie(int b) {
+    baudios = b;
+    for (int i = 0; i < VENTANA_DUPLICADOS; i++) microsRecientes[i] = -1;
+  }
+
+  // Reloj de la PC en microsegundos
+  long ahoraUs() {
+    return System.nanoTime() / 1000L;
+  }
+
+  // ------------------------------------------------------------------
+  // Cuenta los bytes de cada línea recibida (con o sin secuencia)
+  // El uso se recalcula cada 1 s: bits recibidos / bits posibles.
+  // ------------------------------------------------------------------
+  void contarBytes(int n) {
+    long ahora = ahoraUs();
+    if (inicioVentana < 0) inicioVentana = ahora;
+    bytesVentana += n;
+    if (grabando) bytesGrabacion += n;
+    long transcurrido = ahora - inicioVentana;
+    if (transcurrido >= 1000000L) {
+      uso = (float)(bytesVentana * 10.0d * 1000000.0d / ((double)baudios * transcurrido));   // 10 bits por byte (inicio + 8 + parada)
+      bytesVentana = 0;
+      inicioVentana = ahora;
+    }
+  }
+
+  // ------------------------------------------------------------------
+  // Registra una línea de telemetría con su secuencia y los micros() de
+  // captura y de envío. 'largo' es la cantidad de bytes de la línea (incluye "\r\n").
+  // ------------------------------------------------------------------
+  void registrar(long secuencia, long tCaptura, long microsCrudo, int largo) {
+    long tPc = ahoraUs();
+
+    // Secuencia repetida o hacia atrás: es un duplicado si está dentro de la
+    // ventana y coincide su micros; si no, el Arduino se reinició (salto grande
+    // hacia atrás, o secuencia chica con un reloj que arrancó de nuevo)
+    if (ultimaSecuencia >= 0 && secuencia <= ultimaSecuencia) {
+      if (ultimaSecuencia - secuencia < VENTANA_DUPLICADOS &&
+          microsRecientes[(int)(secuencia % VENTANA_DUPLICADOS)] == microsCrudo) {
+        duplicadas++;
+        ultimaCapturaPc = -1;
+        return;
+      }
+      reinicios++;
+      reiniciarReloj();
+      if (secuencia > 0) {     // Las líneas enviadas después del reinicio que no llegaron
+        perdidas += secuencia;
+        huecos++;
+      }
+    } else if (ultimaSecuencia >= 0 && secuencia > ultimaSecuencia + 1) {
+      perdidas += secuencia - ultimaSecuencia - 1;
+      huecos++;
+    }
+    ultimaSecuencia = secuencia;
+    microsRecientes[(int)(secuencia % VENTANA_DUPLICADOS)] = microsCrudo;
+    recibidas++;
+
+    // micros() desborda cada ~71 minutos: se lleva la cuenta de las vueltas
+    if (ultimoMicros >= 0 && microsCrudo < ultimoMicros && ultimoMicros - microsCrudo > 2147483648L) {
+      vueltasMicros++;
+    }
+    ultimoMicros = microsCrudo;
+    long tArduino = microsCrudo + (vueltasMicros << 32);
+
+    // La línea llega completa recién después de transmitir todos sus bytes.
+    // El ajuste se hace con el momento del envío: entre el envío y la llegada solo hay transmisión y USB.
+    long tTransmision = largo * 10L * 1000000L / baudios;
+    actualizarEnvolvente(tArduino, tPc - tArduino - tTransmision);
+
+    // Tiempo desde la captura hasta el envío (resta de 32 bits, igual que micros())
+    long enArduino = (microsCrudo - tCaptura) & 0xFFFFFFFFL;
+    tiempoEnArduino = enArduino / 1000.0;
+
+    ultimaCapturaPc = aRelojPc(tArduino) - enArduino;
+    latenciaLlegada = (tPc - ultimaCapturaPc) / 1000.0;
+    agregarGrabacion(llegadasGrabacion, latenciaLlegada);
+    agregarGrabacion(enArduinoGrabacion, tiempoEnArduino);
+  }
+
+  // ------------------------------------------------------------------
+  // Ping: draw() pregunta si toca mandar uno y escribe la letra devuelta
+  // (0 = no toca). Se manda de a uno y cada uno con otra letra, para que
+  // una respuesta atrasada no se confunda con la del ping siguiente.
+  // ------------------------------------------------------------------
+  synchronized char pingPendiente() {
+    long ahora = ahoraUs();
+    if (envioPing >= 0 && ahora - envioPing < ESPERA_PING_US) return 0;
+    if (ultimoPing >= 0 && ahora - ultimoPing < PERIODO_PING_US) return 0;
+    idPing = (idPing == 'z') ? 'a' : (char)(idPing + 1);
+    envioPing = ultimoPing = ahora;
+    return idPing;
+  }
+
+  // Llega "K<letra>" ('largo' con "\r\n"). Se descuenta la transmisión del
+  // ping (1 byte) y de la respuesta; lo que queda es USB de ida y de vuelta.
+  synchronized void respuestaPing(char id, int largo) {
+    if (envioPing < 0 || id != idPing) return;   // Respuesta de un ping ya abandonado
+    long rtt = ahoraUs() - envioPing - (1 + largo) * 10L * 1000000L / baudios;
+    envioPing = -1;
+    pings++;
+    rttMinimo = Math.min(rttMinimo, Math.max(rtt, 0));
+  }
+
+  // Menor ida y vuelta en ms (0 si todavía no hubo respuesta). El retardo
+  // fijo de un sentido que falta en las latencias está entre 0 y este valor.
+  float pingMinimoMs() {
+    return (pings > 0) ? rttMinimo / 1000.0 : 0;
+  }
+
+  // La muestra de la última línea registrada queda esperando a dibujarse.
+  // Se llama recién cuando sus valores se interpretaron bien.
+  void encolarMuestra() {
+    if (ultimaCapturaPc < 0) return;
+    synchronized (pendientes) {
+      pendientes.add(ultimaCapturaPc);
+    }
+  }
+
+  // Pone en cero los contadores y las latencias (al empezar una grabación,
+  // para que la pantalla muestre solo esa captura). La estimación del reloj
+  // y la última secuencia se conservan.
+  void reiniciarEstadisticas() {
+    recibidas = 0;
+    perdidas = 0;
+    huecos = 0;
+    duplicadas = 0;
+    reinicios = 0;
+    erroresParseo = 0;
+    numLatencias = 0;
+    posLatencia = 0;
+  }
+
+  // Después de un reinicio el reloj del Arduino arranca de nuevo: se descarta la estimación
+  void reiniciarReloj() {
+    ultimoMicros = -1;
+    vueltasMicros = 0;
+    bloques.clear();
+    bloqueInicio = -1;
+    bloqueActual = new long[] { 0, Long.MAX_VALUE };
+    tRef = 0;
+    offsetUs = 0;
+    pendiente = 0;
+    for (int i = 0; i < VENTANA_DUPLICADOS; i++) microsRecientes[i] = -1;
+  }
+
+  // ------------------------------------------------------------------
+  // Agrega una diferencia de relojes y recalcula la recta
+  // ------------------------------------------------------------------
+  void actualizarEnvolvente(long tArduino, long dif) {
+    if (bloqueInicio < 0 || tArduino - bloqueInicio >= DURACION_BLOQUE_US) {
+      if (bloqueInicio >= 0) {
+        bloques.add(bloqueActual);
+        if (bloques.size() > MAX_BLOQUES) bloques.remove(0);
+      }
+      bloqueInicio = tArduino;
+      bloqueActual = new long[] { tArduino, Long.MAX_VALUE };
+    }
+    if (dif < bloqueActual[1]) {
+      bloqueActual[0] = tArduino;
+      bloqueActual[1] = dif;
+    }
+    ajustarRecta();
+  }
+
+  // Recta por mínimos cuadrados sobre los mínimos de cada bloque, bajada
+  // después para que ningún mínimo quede por debajo (envolvente inferior).
+  void ajustarRecta() {
+    int n = bloques.size() + 1;
+    tRef = (bloques.size() > 0) ? bloques.get(0)[0] : bloqueActual[0];
+
+    double sx = 0, sy = 0, sxx = 0, sxy = 0;
+    for (int i = 0; i < n; i++) {
+      long[] b = (i < bloques.size()) ? bloques.get(i) : bloqueActual;
+      double x = b[0] - tRef;
+      double y = b[1];
+      sx += x; sy += y; sxx += x * x; sxy += x * y;
+    }
+    double den = n * sxx - sx * sx;
+    pendiente = (n >= 2 && den > 0) ? (n * sxy - sx * sy) / den : 0;
+    offsetUs = (sy - pendiente * sx) / n;
+
+    double maxBajo = 0;   // Cuánto queda el mínimo más bajo por debajo de la recta
+    for (int i = 0; i < n; i++) {
+      long[] b = (i < bloques.size()) ? bloques.get(i) : bloqueActual;
+      maxBajo = Math.max(maxBajo, offsetUs + pendiente * (b[0] - tRef) - b[1]);
+    }
+    offsetUs -= maxBajo;
+  }
+
+  // Pasa un tiempo del Arduino al reloj de la PC usando la recta estimada
+  long aRelojPc(long tArduino) {
+    return tArduino + Math.round(offsetUs + pendiente * (tArduino - tRef));
+  }
+
+  // Cantidad de muestras esperando a dibujarse. draw() la toma justo antes
+  // de dibujar los valores: esas muestras ya tienen sus valores cargados.
+  int muestrasPendientes() {
+    synchronized (pendientes) {
+      return pendientes.size();
+    }
+  }
+
+  // ------------------------------------------------------------------
+  // Se llama en draw() después de dibujar las regiones, con las 'n' muestras
+  // tomadas antes de dibujar: la latencia muestra → pantalla es el tiempo
+  // desde su captura hasta ahora. Las que llegaron después siguen pendientes.
+  // ------------------------------------------------------------------
+  void muestrasDibujadas(int n) {
+    long ahora = ahoraUs();
+    synchronized (pendientes) {
+      for (int i = 0; i < n && pendientes.size() > 0; i++) {
+        long tCaptura = pendientes.remove(0);
+        float latencia = (ahora - tCaptura) / 1000.0;
+        latencias[posLatencia] = latencia;
+        posLatencia = (posLatencia + 1) % latencias.length;
+        numLatencias = min(numLatencias + 1, latencias.length);
+        agregarGrabacion(latenciasGrabacion, latencia);
+      }
+    }
+  }
+
+  // Percentil (0..100) de las últimas latencias, en ms
+  float percentil(float p) {
+    return percentilDe(sort(subset(latencias, 0, numLatencias)), p);
+  }
+
+  // Percentil (0..100) de un arreglo ya ordenado
+  float percentilDe(float[] ordenadas, float p) {
+    if (ordenadas.length == 0) return 0;
+    int i = constrain(round(p / 100.0 * (ordenadas.length - 1)), 0, ordenadas.length - 1);
+    return ordenadas[i];
+  }
+
+  // ------------------------------------------------------------------
+  // Grabación: desde que empieza se guardan todas las latencias (no solo
+  // las últimas 500) y los bytes, para exportar un resumen completo.
+  // registrar() corre en el hilo del puerto serie, por eso va sincronizado.
+  // ------------------------------------------------------------------
+  synchronized void iniciarGrabacion() {
+    reiniciarEstadisticas();
+    latenciasGrabacion.clear();
+    llegadasGrabacion.clear();
+    enArduinoGrabacion.clear();
+    bytesGrabacion = 0;
+    inicioGrabacion = ahoraUs();
+    grabando = true;
+  }
+
+  synchronized void agregarGrabacion(FloatList lista, float valor) {
+    if (grabando) lista.append(valor);
+  }
+
+  // Termina la grabación y devuelve el resumen para _enlace.txt
+  synchronized String[] terminarGrabacion() {
+    grabando = false;
+    float segundos = (ahoraUs() - inicioGrabacion) / 1000000.0;
+    long enviadas = recibidas + perdidas;
+    float usoMedio = (segundos > 0) ? bytesGrabacion * 10.0 / (baudios * segundos) : 0;   // 10 bits por byte
+    return new String[] {
+      "Duracion de la grabacion: " + nf(segundos, 1, 1) + " s",
+      "Lineas recibidas (con secuencia): " + recibidas,
+      "Lineas perdidas: " + perdidas + " en " + huecos + " huecos (" +
+        nf(enviadas > 0 ? 100.0 * perdidas / enviadas : 0, 1, 2) + " % de " + enviadas + " enviadas)",
+      "Lineas duplicadas: " + duplicadas,
+      "Errores de parseo: " + erroresParseo,
+      "Reinicios del Arduino: " + reinicios,
+      "Bytes recibidos: " + bytesGrabacion + " (uso medio " + nf(usoMedio * 100, 1, 2) + " % de " + baudios + " baud)",
+      lineaPercentiles("Latencia muestra -> pantalla", latenciasGrabacion),
+      lineaPercentiles("Latencia captura -> llegada", llegadasGrabacion),
+      lineaPercentiles("Captura -> envio en el Arduino", enArduinoGrabacion),
+      "Deriva reloj: " + nf((float)(pendiente * 1000000.0d), 1, 2) + " ppm",
+      "Las latencias son relativas al camino mas rapido observado (el retardo fijo del USB queda en el offset)",
+      (pings > 0)
+        ? "Ping ida y vuelta minimo: " + nf(pingMinimoMs(), 1, 2) + " ms en " + pings + " pings (retardo fijo de un sentido entre 0 y " +
+          nf(pingMinimoMs(), 1, 2) + " ms, ~" + nf(pingMinimoMs() / 2, 1, 2) + " ms si es simetrico)"
+        : "Ping ida y vuelta: sin respuestas (firmware sin ping?)"
+    };
+  }
+
+  // "titulo (ms, n): min .. p50 .. p90 .. p95 .. p99 .. max .."
+  String lineaPercentiles(String titulo, FloatList lista) {
+    float[] ordenadas = sort(lista.array());
+    String linea = titulo + " (ms, " + ordenadas.length + " muestras):";
+    float[] ps = { 0, 50, 90, 95, 99, 100 };
+    String[] nombres = { "min", "p50", "p90", "p95", "p99", "max" };
+    for (int i = 0; i < ps.length; i++) linea += "  " + nombres[i] + " " + nf(percentilDe(ordenadas, ps[i]), 1, 2);
+    return linea;
+  }
+
+  // ------------------------------------------------------------------
+  // Resumen en texto para la pantalla (el de la grabación es terminarGrabacion())
+  // Líneas cortas (~32 caracteres) para que entren en REG_ENLACE a textSize(12).
+  // ------------------------------------------------------------------
+  String[] resumen() {
+    if (recibidas == 0) {
+      return new String[] {
+        "Latencia: sin datos con secuencia",
+        "Err parseo: " + erroresParseo
+      };
+    }
+    return new String[] {
+      "Lat p50/95/99: " + nf(percentil(50), 1, 1) + "/" + nf(percentil(95), 1, 1) + "/" + nf(percentil(99), 1, 1) + " ms",
+      "Lat max: " + nf(percentil(100), 1, 1) + " ms  Arduino: " + nf(tiempoEnArduino, 1, 1) + " ms",
+      "Perdidas: " + perdidas + " (" + huecos + " huecos)  Dup: " + duplicadas,
+      "Err parseo: " + erroresParseo + "  Reinicios: " + reinicios,
+      "Enlace: " + nf(uso * 100, 1, 1) + " % de " + baudios + " baud",
+      "Deriva: " + nf((float)(pendiente * 1000000.0d), 1, 1) + " ppm  Ping min: " + nf(pingMinimoMs(), 1, 1) + " ms"
+    };
+  }
+}
@@ -1,8 +1,12 @@
 import processing.serial.*;  // Librería para comunicación serie con Arduino (y otras placas)
 import java.io.PrintWriter;  // Librería para escribir archivos de texto
+import java.text.SimpleDateFormat;  // Fecha y hora con milisegundos para el archivo guardado
+import java.util.Date;
 
 // --- Puerto serie ---
 Serial myPort;  // Objeto Serial que representa el puerto serie usado por Processing
+int baudios = 9600;     // Velocidad del puerto (debe coincidir con la del Arduino)
+EnlaceSerie enlace;     // Latencia, pérdidas y uso del enlace (ver pestaña Enlace)
 
 // --- Configuración de interfaz ---
 int numBotones = 6;   // Cantidad de botones funcionales en la UI
@@ -38,13 +42,37 @@ String nombreArchivoActual = "";
 ArrayList<String> consola = new ArrayList<String>();  // Buffer en memoria para almacenar las líneas que mostramos en la consola dentro de la UI
 int consolaMaxLineas = 200;   // Máximo de líneas que guardaremos en memoria para la consola
 
+// --- Gráficos ---
+int xg = 300;   // Posición horizontal base para los gráficos
+
+// --- Render con capas en caché ---
+// Lo fijo (título, botones, marcos y grillas) se dibuja una sola vez en 'capaEstatica'.
+// En cada frame solo se redibujan las regiones marcadas como sucias.
+PGraphics capaEstatica;          // Capa con todo lo que no cambia entre muestras
+boolean estaticoSucio = true;    // true = hay que reconstruir la capa estática (cambió un botón)
+
+final int REG_RELOJ = 0, REG_VALORES = 1, REG_GRAF_VOLT = 2, REG_GRAF_AMP = 3, REG_GRAF_POT = 4, REG_GRAF_TEMP = 5,
+          REG_INDUCT = 6, REG_CAPAC = 7, REG_GUARDAR = 8, REG_CONSOLA = 9, REG_ENLACE = 10, REG_RENDIMIENTO = 11;
+int numRegiones = 12;
+int[][] regiones = new int[numRegiones][];     // Rectángulo {x, y, ancho, alto} de cada región
+boolean[] sucio = new boolean[numRegiones];    // true = la región se redibuja en el próximo frame
+int ultimoSegundo = -1;                        // Para redibujar el reloj solo cuando cambia
+
+// --- Medición del render ---
+boolean mostrarRendimiento = true;   // Overlay con tiempo de frame y regiones (tecla 'r')
+float msFrame = 0;                   // Tiempo del último frame dibujado (ms)
+float msFramePromedio = 0;           // Promedio móvil del tiempo de frame (ms)
+int regionesDibujadas = 0;           // Regiones redibujadas en el último frame
+int framesDibujados = 0;             // Frames en los que se dibujó algo
+
 void setup() {
   size(1350, 670);      // Tamaño de la ventana de la aplicación (ancho x alto)
 
   // --- Puerto serie ---
   printArray(Serial.list());      // Muestra en consola la lista de puertos disponibles (útil para depurar)
-  myPort = new Serial(this, Serial.list()[2], 9600);      // Abrimos el puerto serie: elegimos el índice 2 de la lista (ajustar si tu puerto está en otro índice)
+  myPort = new Serial(this, Serial.list()[2], baudios);      // Abrimos el puerto serie: elegimos el índice 2 de la lista (ajustar si tu puerto está en otro índice)
   myPort.bufferUntil('\n');       // Buffer hasta nueva línea: serialEvent() se disparará cuando reciba '\n'
+  enlace = new EnlaceSerie(baudios);
 
   // --- Inicializar historiales ---
   // Reservamos memoria para los historiales con la cantidad de muestras definida
@@ -52,48 +80,120 @@ void setup() {
   histAmp  = new float[numMuestras];
   histPot  = new float[numMuestras];
   histTemp = new float[numMuestras];
+
+  // --- Capas y regiones de redibujo ---
+  frameRate(30);    // El frame rate no depende de los datos: los frames sin cambios no dibujan nada
+  capaEstatica = createGraphics(width, height);
+
+  regiones[REG_RELOJ]       = new int[] { width - 420, 45, 410, 25 };
+  regiones[REG_VALORES]     = new int[] { 135, 100, btnAncho + 1, numBotones * (btnAlto + espaciado) };
+  regiones[REG_GRAF_VOLT]   = new int[] { xg, 100, 401, 121 };
+  regiones[REG_GRAF_AMP]    = new int[] { xg, 240, 401, 121 };
+  regiones[REG_GRAF_POT]    = new int[] { xg, 380, 401, 121 };
+  regiones[REG_GRAF_TEMP]   = new int[] { xg, 520, 401, 121 };
+  regiones[REG_INDUCT]      = new int[] { xg + 450, 200, 351, 151 };
+  regiones[REG_CAPAC]       = new int[] { xg + 450, 400, 351, 151 };
+  regiones[REG_GUARDAR]     = new int[] { 1111, height - 100, width - 1111, 100 };   // Desde el borde derecho de la consola
+  regiones[REG_CONSOLA]     = new int[] { 710, 560, 401, 101 };
+  regiones[REG_ENLACE]      = new int[] { 20, 520, 275, 84 };     // 6 líneas de 14 px, termina antes del overlay
+  regiones[REG_RENDIMIENTO] = new int[] { 20, height - 65, 260, 50 };
 }
 
 // --------------------------------------------------------------------
 // DIBUJO PRINCIPAL
+// Solo se redibujan las regiones marcadas como sucias. Si nada cambió
+// no se toca la ventana y queda el frame anterior.
 // --------------------------------------------------------------------
 void draw() {
-  background(220);     // Color de fondo de toda la ventana
- 
-   // --- Título principal ---
-  textSize(24);
-  fill(0);
-  textAlign(CENTER, CENTER);
-  text("Multímetro para Electrónica", width/2, 20);
-  
-  // Volvemos a un tamaño estándar de letra
-  textSize(16);
+  long inicio = System.nanoTime();    // Para medir cuánto tarda el frame
+
+  // Si cambió un botón se reconstruye la capa fija y se redibuja todo
+  if (estaticoSucio) {
+    estaticoSucio = false;
+    construirCapaEstatica();
+    image(capaEstatica, 0, 0);
+    for (int r = 0; r < numRegiones; r++) sucio[r] = true;
+  }
 
-  // --- Fecha y hora ---
-  fill(0);
-  textAlign(RIGHT, TOP);
-  String fecha = nf(day(),2) + "/" + nf(month(),2) + "/" + year();
-  String hora  = nf(hour(),2) + ":" + nf(minute(),2) + ":" + nf(second(),2);
-  text(fecha + "   Hora: " + hora, width - 20, 50);
+  // El reloj solo cambia una vez por segundo
+  if (second() != ultimoSegundo) {
+    ultimoSegundo = second();
+    sucio[REG_RELOJ] = true;
+  }
+
+  // Ping periódico al Arduino: mide el retardo fijo del USB que el offset del reloj no ve
+  char ping = enlace.pingPendiente();
+  if (ping != 0) myPort.write(ping);
+
+  // --- Redibujar las regiones sucias ---
+  int dibujadas = 0;
+  int muestrasListas = 0;   // Muestras cuyos valores se dibujan en este frame
+  for (int r = 0; r < numRegiones; r++) {
+    if (r == REG_RENDIMIENTO || !sucio[r]) continue;
+    sucio[r] = false;     // Se limpia antes de dibujar: si llega una línea mientras tanto queda marcada para el próximo frame
+    if (r == REG_VALORES) muestrasListas = enlace.muestrasPendientes();   // Después de limpiar: las que lleguen ahora vuelven a marcar
+    dibujarRegion(r);
+    dibujadas++;
+  }
+
+  // Las muestras ya están dibujadas: se cierra su latencia muestra → pantalla (incluye el render)
+  if (muestrasListas > 0) {
+    enlace.muestrasDibujadas(muestrasListas);
+    sucio[REG_ENLACE] = true;
+  }
+
+  if (dibujadas == 0 && !sucio[REG_RENDIMIENTO]) return;    // Nada cambió en este frame
+
+  // --- Tiempo de render (sin contar el propio overlay) ---
+  if (dibujadas > 0) {
+    msFrame = (float)((System.nanoTime() - inicio) / 1000000.0);
+    msFramePromedio = (framesDibujados == 0) ? msFrame : msFramePromedio * 0.9 + msFrame * 0.1;
+    regionesDibujadas = dibujadas;
+    framesDibujados++;
+  }
+
+  sucio[REG_RENDIMIENTO] = false;
+  dibujarRegion(REG_RENDIMIENTO);
+}
+
+// --------------------------------------------------------------------
+// CONSTRUYE LA CAPA ESTÁTICA
+// Todo lo que no depende de las mediciones: fondo, título, botones,
+// marcos de los valores, grillas de los gráficos activos y consola.
+// --------------------------------------------------------------------
+void construirCapaEstatica() {
+  PGraphics g = capaEstatica;
+  g.beginDraw();
+  g.background(220);     // Color de fondo de toda la ventana
+
+  // --- Título principal ---
+  g.textSize(24);
+  g.fill(0);
+  g.textAlign(CENTER, CENTER);
+  g.text("Multímetro para Electrónica", width/2, 20);
+
+  // Volvemos a un tamaño estándar de letra
+  g.textSize(16);
+  g.stroke(255);
 
   // --- Botones de funciones ---
   for (int i = 0; i < numBotones; i++) {
-    
+
     // Posición X fija y Y escalonada según el índice
     int x = 20;
     int y = 100 + i * (btnAlto + espaciado);
 
     // Si el botón está activo (seleccionado) lo pintamos verde,
     // si no está activo lo pintamos gris.
-    if (activo[i]) 
-      fill(0, 220, 0);
+    if (activo[i])
+      g.fill(0, 220, 0);
     else
-      fill(180);
-            
-    rect(x, y, btnAncho, btnAlto, 10);    // Dibujar el rectángulo del botón con esquinas redondeadas.
+      g.fill(180);
+
+    g.rect(x, y, btnAncho, btnAlto, 10);    // Dibujar el rectángulo del botón con esquinas redondeadas.
+
+    g.fill(0);    // Color del texto dentro del botón
 
-    fill(0);    // Color del texto dentro del botón
-   
     String etiqueta = "";    // Según el número de botón, asignamos su etiqueta
     switch (i+1) {
       case 1: etiqueta="Voltaje"; break;
@@ -103,35 +203,95 @@ void draw() {
       case 5: etiqueta="Inductancia"; break;
       case 6: etiqueta="Capacitancia"; break;
     }
-    
-    textAlign(CENTER, CENTER);    // Centramos el texto dentro del botón
-    text(etiqueta, x + btnAncho/2, y + btnAlto/2);       // Dibujar la etiqueta dentro del botón
+
+    g.textAlign(CENTER, CENTER);    // Centramos el texto dentro del botón
+    g.text(etiqueta, x + btnAncho/2, y + btnAlto/2);       // Dibujar la etiqueta dentro del botón
+
+    // Fondo del cuadro de valor que va al lado del botón
+    g.fill(240);
+    g.rect(135, y, btnAncho, btnAlto, 10);
   }
 
-  // --- Cuadros de valores ---   (muestra los valores grandes de cada medición)
-  mostrarValores();
+  // --- Marcos y grillas de los gráficos activos ---
+  if (activo[0]) dibujarMarcoGrafico(g, xg, 100, 400, 120, 0, 50, "Voltaje (V)");
+  if (activo[1]) dibujarMarcoGrafico(g, xg, 240, 400, 120, 0, 20, "Amperaje (A)");
+  if (activo[2]) dibujarMarcoGrafico(g, xg, 380, 400, 120, 0, 250, "Potencia (W)");
+  if (activo[3]) dibujarMarcoGrafico(g, xg, 520, 400, 120, 0, 50, "Temperatura (°C)");
 
-  // --------------------------------------------------------------------
-  // GRÁFICOS DE HISTORIA PARA LAS VARIABLES QUE LO USAN
-  // Cada gráfico solo se dibuja si el botón correspondiente está activo
-  // --------------------------------------------------------------------
-  int xg = 300;   // Posición horizontal base para los gráficos
-  
-  if (activo[0]) graficarVariable(xg, 100, 400, 120, histVolt, 0, 50, voltaje, "Voltaje (V)", color(255, 100, 0));          // Gráfico de voltaje
-  if (activo[1]) graficarVariable(xg, 240, 400, 120, histAmp, 0, 20, amperaje, "Amperaje (A)", color(0, 150, 255));         // Gráfico de amperaje
-  if (activo[2]) graficarVariable(xg, 380, 400, 120, histPot, 0, 250, potencia, "Potencia (W)", color(255, 0, 150));        // Gráfico de potencia
-  if (activo[3]) graficarVariable(xg, 520, 400, 120, histTemp, 0, 50, temperatura, "Temperatura (°C)", color(255, 0, 0));   // Gráfico de temperatura
+  if (activo[4]) dibujarMarcoValorGrande(g, xg + 450, 200, "Inductancia");
+  if (activo[5]) dibujarMarcoValorGrande(g, xg + 450, 400, "Capacitancia");
 
-  if (activo[4]) mostrarValorGrande(xg + 450, 200, "Inductancia", inductancia, "uH");       // Valor grande de inductancia (sin gráfico)
-  if (activo[5]) mostrarValorGrande(xg + 450, 400, "Capacitancia", capacitancia);           // Valor grande de capacitancia (String)
- 
-  // --------------------------------------------------------------------
-  // BOTÓN "GUARDAR" PARA ARCHIVAR DATOS DEL MULTÍMETRO
-  // --------------------------------------------------------------------
+  // --- Fondo de la consola ---
+  g.fill(20);
+  g.stroke(255);
+  g.rect(710, 560, 400, 100);
+
+  g.endDraw();
+}
+
+// --------------------------------------------------------------------
+// REDIBUJA UNA REGIÓN
+// Copia el fondo fijo desde la capa estática y dibuja encima solo la
+// parte que cambia. El clip evita que algo se salga de la región.
+// --------------------------------------------------------------------
+void dibujarRegion(int r) {
+  int[] reg = regiones[r];
+  copy(capaEstatica, reg[0], reg[1], reg[2], reg[3], reg[0], reg[1], reg[2], reg[3]);
+  clip(reg[0], reg[1], reg[2], reg[3]);
+  textSize(16);
+
+  switch (r) {
+    case REG_RELOJ:       dibujarReloj(); break;
+    case REG_VALORES:     mostrarValores(); break;
+    case REG_GRAF_VOLT:   if (activo[0]) graficarVariable(xg, 100, 400, 120, histVolt, 0, 50, voltaje, color(255, 100, 0)); break;      // Gráfico de voltaje
+    case REG_GRAF_AMP:    if (activo[1]) graficarVariable(xg, 240, 400, 120, histAmp, 0, 20, amperaje, color(0, 150, 255)); break;     // Gráfico de amperaje
+    case REG_GRAF_POT:    if (activo[2]) graficarVariable(xg, 380, 400, 120, histPot, 0, 250, potencia, color(255, 0, 150)); break;    // Gráfico de potencia
+    case REG_GRAF_TEMP:   if (activo[3]) graficarVariable(xg, 520, 400, 120, histTemp, 0, 50, temperatura, color(255, 0, 0)); break;  // Gráfico de temperatura
+    case REG_INDUCT:      if (activo[4]) mostrarValorGrande(xg + 450, 200, nf(inductancia, 1, 3) + " uH"); break;    // Valor grande de inductancia (sin gráfico)
+    case REG_CAPAC:       if (activo[5]) mostrarValorGrande(xg + 450, 400, capacitancia + " "); break;               // Valor grande de capacitancia (String)
+    case REG_GUARDAR:     dibujarBotonGuardar(); break;
+    case REG_CONSOLA:     dibujarConsola(710, 560, 400, 100); break;
+    case REG_ENLACE:      dibujarEnlace(20, 520); break;
+    case REG_RENDIMIENTO: if (mostrarRendimiento) dibujarRendimiento(20, height - 65); break;
+  }
+
+  noClip();
+}
+
+// --------------------------------------------------------------------
+// MARCA COMO SUCIAS LAS REGIONES QUE DEPENDEN DE LAS MEDICIONES
+// Se llama desde serialEvent() cada vez que llega una línea.
+// --------------------------------------------------------------------
+void marcarDatosSucios() {
+  sucio[REG_VALORES] = true;
+  if (activo[0]) sucio[REG_GRAF_VOLT] = true;
+  if (activo[1]) sucio[REG_GRAF_AMP] = true;
+  if (activo[2]) sucio[REG_GRAF_POT] = true;
+  if (activo[3]) sucio[REG_GRAF_TEMP] = true;
+  if (activo[4]) sucio[REG_INDUCT] = true;
+  if (activo[5]) sucio[REG_CAPAC] = true;
+}
+
+// --------------------------------------------------------------------
+// FECHA Y HORA (arriba a la derecha)
+// --------------------------------------------------------------------
+void dibujarReloj() {
+  fill(0);
+  textAlign(RIGHT, TOP);
+  String fecha = nf(day(),2) + "/" + nf(month(),2) + "/" + year();
+  String hora  = nf(hour(),2) + ":" + nf(minute(),2) + ":" + nf(second(),2);
+  text(fecha + "   Hora: " + hora, width - 20, 50);
+}
+
+// --------------------------------------------------------------------
+// BOTÓN "GUARDAR" PARA ARCHIVAR DATOS DEL MULTÍMETRO
+// --------------------------------------------------------------------
+void dibujarBotonGuardar() {
   int xgbtn = width - 200;    // posición X del botón de guardar
   int ygbtn = height - 100;   // posición Y
 
   // Si está guardando se pone verde, si no, rojo
+  stroke(255);
   fill( guardando ? color(0,200,0) : color(200,0,0) );
   rect(xgbtn, ygbtn, 160, 50, 12);
 
@@ -141,37 +301,58 @@ void draw() {
   textSize(18);
   text( guardando ? "Grabando..." : "Guardar" , xgbtn + 80, ygbtn + 25);
 
-  // Mientras guarda, muestra el nombre del archivo generado
+  // Mientras guarda, muestra el nombre del archivo generado.
+  // Va en dos líneas para que entre entre la consola y el borde de la ventana.
   if (guardando) {
     fill(0);
     textAlign(CENTER, TOP);
     textSize(14);
-    text("Archivo: " + nombreArchivoActual, xgbtn + 80, ygbtn + 60);
+    text("Archivo:", xgbtn + 80, ygbtn + 55);
+    textSize(12);
+    text(nombreArchivoActual, xgbtn + 80, ygbtn + 72);
   }
+}
 
-  // ----------------------------------------------------------
-  // --- DIBUJAR CONSOLA SERIE 
-  // Dibuja la consola pequeña al final de la pantalla, donde se
-  // muestra todo lo transmitido (TX) y recibido (RX) por el puerto serie.
-  dibujarConsola(710, 560, 400, 100);
+// --------------------------------------------------------------------
+// ESTADÍSTICAS DEL ENLACE (latencia, pérdidas, uso y deriva del reloj)
+// --------------------------------------------------------------------
+void dibujarEnlace(int x, int y) {
+  fill(0);
+  textAlign(LEFT, TOP);
+  textSize(12);
+  String[] lineas = enlace.resumen();
+  for (int i = 0; i < lineas.length; i++) {
+    text(lineas[i], x, y + i * 14);
+  }
+}
+
+// --------------------------------------------------------------------
+// OVERLAY DE RENDIMIENTO (tecla 'r' para mostrar/ocultar)
+// Tiempo del último frame dibujado y cuántas regiones se redibujaron.
+// Líneas de hasta ~34 caracteres para que entren en los 260 px de REG_RENDIMIENTO.
+// --------------------------------------------------------------------
+void dibujarRendimiento(int x, int y) {
+  fill(0);
+  textAlign(LEFT, TOP);
+  textSize(12);
+  text("Frame: " + nf(msFrame, 1, 2) + " ms  (prom. " + nf(msFramePromedio, 1, 2) + " ms)", x, y);
+  text("Regiones redibujadas: " + regionesDibujadas + " de " + (numRegiones - 1), x, y + 16);
+  text("Frames: " + framesDibujados + "/" + frameCount + "  " + nf(frameRate, 1, 1) + " fps", x, y + 32);
 }
 
 // --------------------------------------------------------------------
 // MOSTRAR VALORES PEQUEÑOS JUNTO A CADA BOTÓN
+// (el fondo de cada cuadro está en la capa estática)
 // --------------------------------------------------------------------
 void mostrarValores() {
   for (int i = 0; i < numBotones; i++) {
-   
+
     // Posición del cuadro donde se muestran los valores
     int x = 135;
     int y = 100 + i * (btnAlto + espaciado);
 
-    // Fondo del cuadro de valor
-    fill(240);
-    rect(x, y, btnAncho, btnAlto, 10);
-
     fill(0);    // Color del texto
-    
+
     // Texto a mostrar según la variable activa
     String texto = "";
     switch (i+1) {
@@ -182,7 +363,7 @@ void mostrarValores() {
       case 5: texto = nf(inductancia, 1, 2) + " uH"; break;
       case 6: texto = capacitancia; break;         // Capacitancia ya viene como String (ejemplo "25.54 uF")
     }
-    
+
     textAlign(CENTER, CENTER);      // Centrar el texto en el cuadro
     text(texto, x + btnAncho/2, y + btnAlto/2);
   }
@@ -201,6 +382,7 @@ void mousePressed() {
     // Verifica si el clic cayó dentro del botón
     if (mouseX > x && mouseX < x + btnAncho && mouseY > y && mouseY < y + btnAlto) {
       activo[i] = !activo[i];       // Cambia el estado ON/OFF del botón
+      estaticoSucio = true;         // Cambian el botón y los gráficos visibles: hay que rehacer la capa fija
 
       String codigo = "";        // Código a enviar por serial al Arduino
 
@@ -225,6 +407,7 @@ void mousePressed() {
       mouseY > ygbtn && mouseY < ygbtn + 50) {
 
     guardando = !guardando;  // ON/OFF
+    sucio[REG_GUARDAR] = true;
 
     if (guardando) {   
       
@@ -236,6 +419,9 @@ void mousePressed() {
       output = createWriter(fileName);    // Abrir archivo para escritura
       nombreArchivoActual = fileName;
 
+      enlace.iniciarGrabacion();     // El resumen del enlace cubre solo esta grabación
+      sucio[REG_ENLACE] = true;
+
       println("Guardando en archivo: " + fileName);
       logConsola(">> Grabando en archivo " + fileName);
     } else {     // Si estaba grabando, cerramos el archivo correctamente
@@ -243,23 +429,62 @@ void mousePressed() {
         output.flush();
         output.close();
       }
+
+      // Resumen del enlace de toda la grabación (latencias, pérdidas, bytes, uso) junto a la captura
+      PrintWriter resumen = createWriter(fileName.replace(".txt", "_enlace.txt"));
+      for (String linea : enlace.terminarGrabacion()) resumen.println(linea);
+      resumen.flush();
+      resumen.close();
+
       println("Guardado detenido.");
       logConsola(">> Grabación detenida");
     }
   }
 }
 
+// --------------------------------------------------------------------
+// TECLADO: 'r' muestra/oculta el overlay de rendimiento
+// --------------------------------------------------------------------
+void keyPressed() {
+  if (key == 'r' || key == 'R') {
+    mostrarRendimiento = !mostrarRendimiento;
+    sucio[REG_RENDIMIENTO] = true;
+  }
+}
+
 // --------------------------------------------------------------------
 // EVENTO SERIAL: SE EJECUTA CADA VEZ QUE LLEGA UNA LÍNEA
 // --------------------------------------------------------------------
 void serialEvent(Serial p) {
   String lectura = p.readStringUntil('\n');    // Leer línea completa hasta salto de línea
   if (lectura != null) {
+    int largo = lectura.length();   // Bytes de la línea tal como llegó (con "\r\n")
+    enlace.contarBytes(largo);
     lectura = lectura.trim();   // limpiar espacios y saltos
+
+    // Respuesta a un ping ("K<letra>"): no es telemetría ni se muestra en la consola
+    if (lectura.length() == 2 && lectura.charAt(0) == 'K') {
+      enlace.respuestaPing(lectura.charAt(1), largo);
+      return;
+    }
     println("Recibido: " + lectura);
     logConsola("RX: " + lectura);
 
-    try {    // Decodificar cada variable solo si aparece su letra
+    try {
+      // Secuencia y tiempos de captura y envío del Arduino ("S<n>,U<micros>,E<micros>," al principio de la línea)
+      long secuencia = -1;
+      long tCaptura = -1;
+      long tEnvio = -1;
+      if (lectura.length() > 1 && lectura.charAt(0) == 'S' && Character.isDigit(lectura.charAt(1))) {
+        secuencia = extraerEntero(lectura, 'S');
+        tCaptura = extraerEntero(lectura, 'U');
+        tEnvio = extraerEntero(lectura, 'E');
+
+        // Se registra antes de leer los valores: si alguno falla la línea cuenta solo como error de parseo, no como perdida
+        enlace.registrar(secuencia, tCaptura, tEnvio, largo);
+      }
+
+      // Decodificar cada variable solo si aparece su letra
       if (lectura.indexOf('V') != -1) voltaje = extraerValor(lectura, 'V');
       if (lectura.indexOf('A') != -1) amperaje = extraerValor(lectura, 'A');
       if (lectura.indexOf('P') != -1) potencia = extraerValor(lectura, 'P');
@@ -274,18 +499,26 @@ void serialEvent(Serial p) {
       actualizarHistorial(histPot, potencia);
       actualizarHistorial(histTemp, temperatura);
 
+      // Solo las líneas que se pudieron interpretar entran en la latencia muestra → pantalla.
+      // Se encola antes de marcar: un frame que vea la marca ya encuentra la muestra.
+      if (secuencia >= 0) enlace.encolarMuestra();
+      marcarDatosSucios();     // Redibujar valores y gráficos en el próximo frame
+
       if (guardando && output != null) {         // Si se está guardando, escribir línea en archivo
-        String fecha = nf(day(),2)+"/"+nf(month(),2)+"/"+year();
-        String hora  = nf(hour(),2)+":"+nf(minute(),2)+":"+nf(second(),2);
+        String fechaHora = new SimpleDateFormat("dd/MM/yyyy,HH:mm:ss.SSS").format(new Date());   // Fecha y hora con milisegundos
 
+        // Al final: secuencia, micros() de captura y de envío y latencia captura → llegada (vacíos si la línea no los trae)
         output.println(
-          fecha + "," + hora + "," +
+          fechaHora + "," +
           voltaje + "," + amperaje + "," + potencia + "," +
-          temperatura + "," + inductancia + "," + capacitancia
+          temperatura + "," + inductancia + "," + capacitancia + "," +
+          (secuencia >= 0 ? secuencia + "," + tCaptura + "," + tEnvio + "," + nf(enlace.latenciaLlegada, 1, 2) : ",,,")
         );
       }
 
     } catch (Exception e) {
+      enlace.erroresParseo++;
+      sucio[REG_ENLACE] = true;
       println("Error procesando: " + e);
       logConsola("ERROR: " + e);
     }
@@ -309,7 +542,26 @@ float extraerValor(String s, char clave) {
 
   num = trim(num);  // Quitar espacios y caracteres raros
   
-  return float(num);  // Convertir a float
+  float valor = float(num);  // Convertir a float
+  if (Float.isNaN(valor)) throw new NumberFormatException("valor invalido en " + clave + ": " + num);   // Se cuenta como error de parseo
+  return valor;
+}
+
+// --------------------------------------------------------------------
+// EXTRAER ENTEROS LARGOS (secuencia y micros() del Arduino)
+// Ejemplo: "S152,U30412876,E30655120,V12.4"  →  'S' = 152, 'U' = 30412876
+// Se usa long porque micros() no entra en un float sin perder precisión.
+// --------------------------------------------------------------------
+long extraerEntero(String s, char clave) {
+  int start = s.indexOf(clave);
+  if (start == -1) throw new NumberFormatException("falta " + clave);
+
+  int end = s.indexOf(",", start);
+  String num = (end != -1) ?
+       s.substring(start + 1, end) :
+       s.substring(start + 1);
+
+  return Long.parseLong(trim(num));
 }
 
 // --------------------------------------------------------------------
@@ -342,42 +594,52 @@ void actualizarHistorial(float[] hist, float nuevo) {      // Desplazar todos lo
 }
 
 // --------------------------------------------------------------------
-// GRAFICA UNA VARIABLE EN TIEMPO REAL USANDO HISTORIAL DE DATOS
-// - x0, y0 → posición del gráfico
-// - datos[] → historial deslizante
-// - minVal / maxVal → escala vertical
-// - actual → valor actual (línea azul)
+// DIBUJA LA PARTE FIJA DE UN GRÁFICO EN UNA CAPA
+// Marco, título y líneas de referencia con sus etiquetas. Solo cambia
+// cuando se activa/desactiva el gráfico, por eso va en la capa estática.
 // --------------------------------------------------------------------
-void graficarVariable(int x0, int y0, int ancho, int alto,
-                      float[] datos, float minVal, float maxVal,
-                      float actual, String titulo, color c) {
+void dibujarMarcoGrafico(PGraphics g, int x0, int y0, int ancho, int alto,
+                         float minVal, float maxVal, String titulo) {
 
-  fill(255);     // Fondo del gráfico
-  stroke(0);
-  rect(x0, y0, ancho, alto);
+  g.fill(255);     // Fondo del gráfico
+  g.stroke(0);
+  g.rect(x0, y0, ancho, alto);
 
-  fill(0);     // Título
-  textAlign(LEFT, TOP);
-  text(titulo, x0 + 10, y0 + 5);
+  g.fill(0);     // Título
+  g.textAlign(LEFT, TOP);
+  g.text(titulo, x0 + 10, y0 + 5);
+
+  g.stroke(180);      // Líneas horizontales de referencia
 
-  stroke(180);      // Líneas horizontales de referencia
-  
   for (int i = 0; i <= 4; i++) {
     float v = map(i, 0, 4, minVal, maxVal);       // Valor correspondiente a la línea
     float y = map(v, minVal, maxVal, y0 + alto - 20, y0 + 20);       // Posición vertical mapeada
-    line(x0 + 50, y, x0 + ancho - 10, y);     // Línea de referencia
-    
+    g.line(x0 + 50, y, x0 + ancho - 10, y);     // Línea de referencia
+
     // Etiqueta del valor
-    fill(0);  
-    textAlign(RIGHT, CENTER);
-    text(nf(v, 1, 1), x0 + 45, y);
+    g.fill(0);
+    g.textAlign(RIGHT, CENTER);
+    g.text(nf(v, 1, 1), x0 + 45, y);
   }
+}
+
+// --------------------------------------------------------------------
+// GRAFICA UNA VARIABLE EN TIEMPO REAL USANDO HISTORIAL DE DATOS
+// (el marco y la grilla ya están en la capa estática)
+// - x0, y0 → posición del gráfico
+// - datos[] → historial deslizante
+// - minVal / maxVal → escala vertical
+// - actual → valor actual (línea azul)
+// --------------------------------------------------------------------
+void graficarVariable(int x0, int y0, int ancho, int alto,
+                      float[] datos, float minVal, float maxVal,
+                      float actual, color c) {
 
     // --- Curva del historial ---
   stroke(c);
   noFill();
   beginShape();
-  
+
   for (int i = 0; i < datos.length; i++) {
     float x = map(i, 0, datos.length-1, x0 + 55, x0 + ancho - 10);
     float y = map(datos[i], minVal, maxVal, y0 + alto - 20, y0 + 20);
@@ -389,7 +651,7 @@ void graficarVariable(int x0, int y0, int ancho, int alto,
   stroke(0, 0, 255);
   float yAct = map(actual, minVal, maxVal, y0 + alto - 20, y0 + 20);
   line(x0 + 50, yAct, x0 + ancho - 10, yAct);
-  
+
   // Texto del valor actual
   fill(0, 0, 255);
   textAlign(LEFT, CENTER);
@@ -397,45 +659,35 @@ void graficarVariable(int x0, int y0, int ancho, int alto,
 }
 
 // --------------------------------------------------------------------
-// MUESTRA UN CUADRO GRANDE DE VALOR (para inductancia, voltaje, etc.)
+// DIBUJA EL MARCO Y EL TÍTULO DE UN CUADRO GRANDE DE VALOR EN UNA CAPA
 // --------------------------------------------------------------------
-void mostrarValorGrande(int x, int y, String titulo, float valor, String unidad) {
- 
+void dibujarMarcoValorGrande(PGraphics g, int x, int y, String titulo) {
+
   // Marco y fondo
-  fill(255);
-  stroke(0);
-  rect(x, y, 350, 150, 10);
+  g.fill(255);
+  g.stroke(0);
+  g.rect(x, y, 350, 150, 10);
 
   // Título
-  fill(0);
-  textAlign(CENTER, TOP);
-  textSize(20);
-  text(titulo, x + 175, y + 10);
+  g.fill(0);
+  g.textAlign(CENTER, TOP);
+  g.textSize(20);
+  g.text(titulo, x + 175, y + 10);
 
-  // Valor grande
-  textSize(32);
-  text(nf(valor, 1, 3) + " " + unidad, x + 175, y + 70);
-
-  textSize(16);    // Restablecer tamaño
+  g.textSize(16);    // Restablecer tamaño
 }
 
 // --------------------------------------------------------------------
-// VERSIÓN PARA CAPACITANCIA ya viene como String (ej: "22.34 uF")
+// MUESTRA EL VALOR DE UN CUADRO GRANDE (inductancia, capacitancia)
+// El texto ya viene formateado (ej: "12.345 uH" o "22.34 uF")
 // --------------------------------------------------------------------
-void mostrarValorGrande(int x, int y, String titulo, String textoValor) {
-  fill(255);
-  stroke(0);
-  rect(x, y, 350, 150, 10);
-
+void mostrarValorGrande(int x, int y, String textoValor) {
   fill(0);
   textAlign(CENTER, TOP);
-  textSize(20);
-  text(titulo, x + 175, y + 10);
-
   textSize(32);
-  text(textoValor + " " , x + 175, y + 70);
+  text(textoValor, x + 175, y + 70);
 
-  textSize(16);
+  textSize(16);    // Restablecer tamaño
 }
 
 
@@ -450,6 +702,7 @@ void logConsola(String msg) {
     consola.remove(0);
   }
   consola.add(msg);    // Agregar nueva línea al final
+  sucio[REG_CONSOLA] = true;
 }
 
 
@@ -459,10 +712,7 @@ void logConsola(String msg) {
 // --------------------------------------------------------------------
 void dibujarConsola(int x, int y, int w, int h) {
   
-  // Fondo negro 
-  fill(20);
-  stroke(255);
-  rect(x, y, w, h);
+  // El fondo negro está en la capa estática
 
   // Texto verde 
   fill(0, 255, 0);